@@ -0,0 +1,263 @@
+#include "DawProfiles.h"
+
+namespace
+{
+    // Written to daw-profiles.json on first launch so it can be edited.
+    // "protocol": "auto" | "hui" | "mcu"
+    // "accelerationCurve": "none" | "linear" | "exponential" (leave out to use the menu setting)
+    // "keys": [{"key": <macOS keycode>, "action": "faderUp" | "faderDown" | "bankLeft" | "bankRight" | "snapshot" | "ramp",
+    //           "fader": 1-8, "slot": 1-8,
+    //           "targetDb": <dB> | "-inf", "durationMs": 0-60000, "shape": "linear" | "log" | "scurve"}]
+    //         (a ramp without "fader" moves the fader whose key was pressed last)
+    //         (leave out to use the default layout)
+    // "taper": "protools" | "mackie" | [[position 0-1, dB], ...] rising from position 0 to 1
+    //          (leave out to pick by protocol)
+    // "taperSamples": [[position 0-1, dB | "-inf"], ...] read off the DAW's own fader, checked against the taper
+    constexpr const char *defaultProfilesJson = R"({
+  "profiles": [
+    { "name": "Pro Tools",  "match": "com.avid.ProTools",       "protocol": "auto", "taper": "protools" },
+    { "name": "Logic Pro",  "match": "com.apple.logic10",       "protocol": "auto", "taper": "mackie" },
+    { "name": "Ableton",    "match": "com.ableton.live",        "protocol": "auto" },
+    { "name": "Reaper",     "match": "com.cockos.reaper",       "protocol": "auto" },
+    { "name": "Cubase",     "match": "com.steinberg.cubase*",   "protocol": "auto" },
+    { "name": "Studio One", "match": "com.presonus.studioone*", "protocol": "auto" },
+    { "name": "Luna",       "match": "com.uaudio.luna",         "protocol": "auto" }
+  ]
+}
+)";
+
+    ControlProtocol parseProtocol(const juce::String &text)
+    {
+        if (text.equalsIgnoreCase("hui"))
+            return ControlProtocol::Hui;
+        if (text.equalsIgnoreCase("mcu"))
+            return ControlProtocol::Mcu;
+        return ControlProtocol::Unknown;
+    }
+
+    std::optional<MotionCurve::Shape> parseCurve(const juce::String &text)
+    {
+        if (text.equalsIgnoreCase("none"))
+            return MotionCurve::Shape::Constant;
+        if (text.equalsIgnoreCase("linear"))
+            return MotionCurve::Shape::Linear;
+        if (text.equalsIgnoreCase("exponential"))
+            return MotionCurve::Shape::Exponential;
+        return std::nullopt;
+    }
+
+    FaderRamp::Shape parseRampShape(const juce::String &text)
+    {
+        if (text.equalsIgnoreCase("log"))
+            return FaderRamp::Shape::LogTaper;
+        if (text.equalsIgnoreCase("scurve"))
+            return FaderRamp::Shape::SCurve;
+        return FaderRamp::Shape::Linear;
+    }
+
+    KeyAction parseRampKey(const juce::var &key)
+    {
+        const auto faderIndex = key.hasProperty("fader") ? juce::jlimit(1, 8, (int)key["fader"]) - 1
+                                                         : (int)KeyAction::lastFaderKey;
+
+        // "-inf" (or anything at the bottom of the taper) fades all the way out
+        const auto &target = key["targetDb"];
+        const double targetDb = target.isString() ? FaderTaper::floorDb
+                                                  : juce::jlimit(FaderTaper::floorDb, 12.0, (double)target);
+
+        return KeyBindings::rampKey(faderIndex, (float)targetDb,
+                                    juce::jlimit(0, 60000, (int)key.getProperty("durationMs", 1000)),
+                                    parseRampShape(key["shape"].toString()));
+    }
+
+    /** Builds a key table from a "keys" array, or returns the default layout if there is none */
+    KeyBindings::Table parseKeyTable(const juce::var &keys)
+    {
+        const auto *keyArray = keys.getArray();
+        if (keyArray == nullptr)
+            return KeyBindings::defaultTable;
+
+        std::vector<KeyBindings::Binding> bindings;
+
+        for (const auto &key : *keyArray)
+        {
+            const int keyCode = key["key"];
+            const auto action = key["action"].toString();
+            const int faderIndex = juce::jlimit(1, 8, (int)key.getProperty("fader", 1)) - 1;
+
+            if (action == "faderUp")
+                bindings.push_back({keyCode, KeyBindings::faderKey(faderIndex, true)});
+            else if (action == "faderDown")
+                bindings.push_back({keyCode, KeyBindings::faderKey(faderIndex, false)});
+            else if (action == "bankLeft")
+                bindings.push_back({keyCode, KeyBindings::bankKey(MidiEncoding::BankAction::Left, MidiEncoding::BankAction::Left8)});
+            else if (action == "bankRight")
+                bindings.push_back({keyCode, KeyBindings::bankKey(MidiEncoding::BankAction::Right, MidiEncoding::BankAction::Right8)});
+            else if (action == "snapshot")
+                bindings.push_back({keyCode, KeyBindings::snapshotKey(juce::jlimit(1, 8, (int)key.getProperty("slot", 1)) - 1)});
+            else if (action == "ramp")
+                bindings.push_back({keyCode, parseRampKey(key)});
+            else
+                DBG("Unknown key action in DAW profile: " << action);
+        }
+
+        return KeyBindings::buildTable(bindings.data(), bindings.size());
+    }
+
+    // How far a profile's taper may be from its "taperSamples". A DAW shows gain to 0.1 dB,
+    // and a position set by hand is only good to a step or so
+    constexpr double taperSampleToleranceDb = 0.5;
+
+    /** Reads [[position, dB], ...] points, with "-inf" as the bottom of the fader */
+    std::vector<FaderTaper::Point> parseTaperPoints(const juce::var &pointList)
+    {
+        std::vector<FaderTaper::Point> points;
+
+        if (const auto *pointArray = pointList.getArray())
+            for (const auto &point : *pointArray)
+                points.push_back({point[0], point[1].isString() ? FaderTaper::floorDb : (double)point[1]});
+
+        return points;
+    }
+}
+
+// LOADING
+//==============================================================================
+DawProfiles::DawProfiles()
+{
+    loadFromJson(defaultProfilesJson);
+}
+
+void DawProfiles::loadFromFile(const juce::File &file)
+{
+    if (!file.existsAsFile() && !file.replaceWithText(defaultProfilesJson))
+        DBG("Failed to write default DAW profiles to " << file.getFullPathName());
+
+    if (!file.existsAsFile() || !loadFromJson(file.loadFileAsString()))
+    {
+        DBG("Using built-in DAW profiles");
+        loadFromJson(defaultProfilesJson);
+    }
+}
+
+bool DawProfiles::loadFromJson(const juce::String &json)
+{
+    const auto root = juce::JSON::parse(json);
+    const auto *profileArray = root["profiles"].getArray();
+
+    if (profileArray == nullptr)
+    {
+        DBG("DAW profiles have no \"profiles\" array");
+        return false;
+    }
+
+    profiles.clear();
+    customTapers.clear();
+    rules.clear();
+
+    for (const auto &entry : *profileArray)
+    {
+        auto match = entry["match"].toString();
+        if (match.isEmpty())
+            continue;
+
+        auto profile = std::make_unique<DawProfile>();
+        profile->name = entry.getProperty("name", match).toString();
+        profile->enabled = entry.getProperty("enabled", true);
+        profile->protocol = parseProtocol(entry["protocol"].toString());
+        profile->accelerationCurve = parseCurve(entry["accelerationCurve"].toString());
+        profile->keyTable = parseKeyTable(entry["keys"]);
+        profile->taper = parseTaper(entry["taper"]);
+
+        // Measured samples check the profile's taper, or the protocol's when the profile forces one
+        const auto samples = parseTaperPoints(entry["taperSamples"]);
+        auto *checkedTaper = profile->taper;
+        if (checkedTaper == nullptr && profile->protocol == ControlProtocol::Hui)
+            checkedTaper = &FaderTaper::getProTools();
+        else if (checkedTaper == nullptr && profile->protocol == ControlProtocol::Mcu)
+            checkedTaper = &FaderTaper::getMackie();
+
+        // Taps only step in dB on measured points, or a taper the DAW's own readings agree with
+        if (!samples.empty() && checkedTaper != nullptr)
+        {
+            profile->isTaperMeasured = checkedTaper->validate(samples, taperSampleToleranceDb);
+
+            if (!profile->isTaperMeasured)
+                DBG("DAW profile " << profile->name << ": the fader taper doesn't match its taperSamples");
+        }
+        else
+        {
+            profile->isTaperMeasured = entry["taper"].isArray() && profile->taper != nullptr;
+        }
+
+        const bool isPrefix = match.endsWithChar('*');
+        if (isPrefix)
+            match = match.dropLastCharacters(1);
+
+        rules.push_back({match, isPrefix, profile.get()});
+        profiles.push_back(std::move(profile));
+    }
+
+    return true;
+}
+
+const FaderTaper *DawProfiles::parseTaper(const juce::var &taper)
+{
+    if (taper.isArray())
+    {
+        auto points = parseTaperPoints(taper);
+
+        // Tables are only built from points that rise from the bottom to the top of the fader
+        const bool isRising = points.size() >= 2
+                              && points.front().position == 0.0
+                              && points.back().position == 1.0
+                              && std::adjacent_find(points.begin(), points.end(), [](const auto &a, const auto &b) {
+                                     return b.position <= a.position || b.db <= a.db;
+                                 }) == points.end();
+
+        if (!isRising)
+        {
+            DBG("DAW profile taper points must rise from position 0 to 1");
+            return nullptr;
+        }
+
+        auto custom = std::make_unique<FaderTaper>(std::move(points));
+        if (!custom->checkTables())
+            return nullptr;
+
+        customTapers.push_back(std::move(custom));
+        return customTapers.back().get();
+    }
+
+    const auto name = taper.toString();
+    if (name.equalsIgnoreCase("protools"))
+        return &FaderTaper::getProTools();
+    if (name.equalsIgnoreCase("mackie"))
+        return &FaderTaper::getMackie();
+
+    return nullptr;
+}
+
+// LOOKUP
+//==============================================================================
+const DawProfile *DawProfiles::resolve(const juce::String &applicationId) const
+{
+    const DawProfile *bestPrefixMatch = nullptr;
+    int bestPrefixLength = -1;
+
+    for (const auto &rule : rules)
+    {
+        if (!rule.isPrefix)
+        {
+            if (applicationId == rule.pattern)
+                return rule.profile;
+        }
+        else if (applicationId.startsWith(rule.pattern) && rule.pattern.length() > bestPrefixLength)
+        {
+            bestPrefixMatch = rule.profile;
+            bestPrefixLength = rule.pattern.length();
+        }
+    }
+
+    return bestPrefixMatch;
+}
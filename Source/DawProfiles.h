@@ -0,0 +1,60 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <optional>
+#include <vector>
+#include "FaderTaper.h"
+#include "KeyMap.h"
+#include "MotionCurve.h"
+#include "ProtocolDetector.h"
+
+/** Settings for one DAW. Built once when profiles load and never changed after */
+struct DawProfile
+{
+    juce::String name;
+    bool enabled = true;                                 // Capture keys while this DAW is focused
+    ControlProtocol protocol = ControlProtocol::Unknown; // Unknown detects it from feedback
+    std::optional<MotionCurve::Shape> accelerationCurve; // Not set uses the menu setting
+    KeyBindings::Table keyTable = KeyBindings::defaultTable;
+    const FaderTaper *taper = nullptr;                   // Not set uses the usual one for the protocol
+    bool isTaperMeasured = false;                        // Taps step in exact dB only on a measured taper
+};
+
+/**
+ * Per-DAW profiles loaded from daw-profiles.json next to the settings file.
+ * Each profile matches an application ID exactly, or by prefix when its
+ * match ends in '*' (e.g. "com.steinberg.cubase*"). Matching is only done
+ * when focus changes; the key path just follows the resolved pointer.
+ */
+class DawProfiles
+{
+public:
+    DawProfiles();
+
+    /** Loads profiles from a file, writing the built-in ones there first if it doesn't exist.
+        Call from the message thread, before any profile is resolved */
+    void loadFromFile(const juce::File &file);
+
+    /** The profile for an application ID, or nullptr if it isn't a known DAW.
+        Exact matches win over prefixes, then the longest prefix wins */
+    const DawProfile *resolve(const juce::String &applicationId) const;
+
+private:
+    bool loadFromJson(const juce::String &json);
+
+    struct Rule
+    {
+        juce::String pattern;
+        bool isPrefix;
+        const DawProfile *profile;
+    };
+
+    /** A built-in taper by name, or one built from [[position, dB], ...] points */
+    const FaderTaper *parseTaper(const juce::var &taper);
+
+    std::vector<std::unique_ptr<const DawProfile>> profiles;
+    std::vector<std::unique_ptr<const FaderTaper>> customTapers;
+    std::vector<Rule> rules;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DawProfiles)
+};
@@ -0,0 +1,711 @@
+#include "EngineBench.h"
+
+#include <thread>
+
+namespace
+{
+    constexpr const char *benchFlag = "--bench-engine";
+    constexpr const char *fuzzFlag = "--fuzz-engine";
+    constexpr const char *stressFlag = "--stress-fader-state";
+    constexpr int defaultMsPerCase = 1000;
+    constexpr int defaultFuzzRounds = 1000;
+    constexpr int defaultMsToStress = 2000;
+
+    // Encoder and decoder calls per batch, so the clock is read once per batch
+    constexpr int batchSize = 4096;
+
+    // What one fuzz round feeds the engine
+    constexpr int messagesPerRound = 64;
+    constexpr int keysPerRound = 32;
+
+    // How long the engine thread gets to catch up with the posted keys
+    constexpr int engineTimeoutMs = 5000;
+
+    // Fader 1-8 up and down keys from the default key map
+    constexpr std::array<int, 16> faderKeyCodes{12, 0, 13, 1, 14, 2, 15, 3, 17, 5, 16, 4, 32, 38, 34, 40};
+
+    // System messages with a fixed length (no sysex start or end)
+    constexpr std::array<uint8_t, 10> systemStatuses{0xF1, 0xF2, 0xF3, 0xF6, 0xF8, 0xFA, 0xFB, 0xFC, 0xFE, 0xFF};
+
+    // Keeps encoder results alive so the timed loops aren't optimised away
+    volatile uint32_t sink = 0;
+
+    template <size_t Size>
+    uint32_t checksum(const std::array<uint8_t, Size> &burst)
+    {
+        uint32_t sum = 0;
+        for (const auto byte : burst)
+            sum += byte;
+        return sum;
+    }
+
+    /** Logs and returns events per second */
+    double logRate(const juce::String &name, juce::int64 numEvents, juce::int64 elapsedTicks)
+    {
+        const double seconds = juce::jmax(1.0e-9, juce::Time::highResolutionTicksToSeconds(elapsedTicks));
+
+        juce::Logger::writeToLog(name + ": " + juce::String(numEvents) + " in " + juce::String(seconds, 3) + "s, "
+                                 + juce::String((double)numEvents / seconds, 0) + " events/s, "
+                                 + juce::String(seconds * 1.0e9 / (double)juce::jmax((juce::int64)1, numEvents), 1) + " ns each");
+        return (double)numEvents / seconds;
+    }
+
+    /** Calls a case in batches for about ms milliseconds, logs its rate and returns it in events per second */
+    template <typename Case>
+    double timeCase(const juce::String &name, int ms, Case &&runOne)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        const auto end = start + juce::Time::getHighResolutionTicksPerSecond() * ms / 1000;
+        auto now = start;
+        juce::int64 numEvents = 0;
+        uint32_t sum = 0;
+
+        while (now < end)
+        {
+            for (int i = 0; i < batchSize; ++i)
+                sum += runOne(i);
+
+            numEvents += batchSize;
+            now = juce::Time::getHighResolutionTicks();
+        }
+
+        sink = sink + sum;
+        return logRate(name, numEvents, now - start);
+    }
+
+    /**
+     * Stands in for the surface's MIDI output in the nudge cases: counts what
+     * each path hands to the OS, without the OS call itself
+     */
+    struct CountingOutput
+    {
+        juce::int64 numBytes = 0;
+        juce::int64 numSends = 0;
+
+        uint32_t send(const uint8_t *bytes, int size)
+        {
+            numBytes += size;
+            ++numSends;
+            return bytes[size - 1];
+        }
+
+        void logPerNudge(const juce::String &name, juce::int64 numNudges) const
+        {
+            juce::Logger::writeToLog(name + ": " + juce::String((double)numBytes / (double)numNudges, 1) + " bytes and "
+                                     + juce::String((double)numSends / (double)numNudges, 1) + " sends per nudge");
+        }
+    };
+
+    /** One nudge the way the engine first sent it: six HUI controllers and a pitch wheel as juce::MidiMessages */
+    uint32_t sendLegacyNudge(CountingOutput &output, int faderIndex, int value)
+    {
+        const int msb = (value >> 7) & 0x7F;
+        const int lsb = value & 0x7F;
+
+        const std::array<std::pair<int, int>, 6> controls{{
+            {0x0F, faderIndex}, {0x2F, 0x40}, {faderIndex, msb}, {0x20 | faderIndex, lsb}, {0x0F, faderIndex}, {0x2F, 0x00}
+        }};
+
+        std::vector<juce::MidiMessage> messages;
+        messages.reserve(controls.size());
+
+        for (const auto &[control, controlValue] : controls)
+            messages.emplace_back(juce::MidiMessage::controllerEvent(1, control, controlValue));
+
+        uint32_t sum = 0;
+        for (const auto &message : messages)
+            sum += output.send(message.getRawData(), message.getRawDataSize());
+
+        const auto pitchWheel = juce::MidiMessage::pitchWheel(faderIndex + 1, value);
+        return sum + output.send(pitchWheel.getRawData(), pitchWheel.getRawDataSize());
+    }
+
+    /** One nudge the way FaderSurface sends it now: both bursts queued into the output buffer, one send per flush */
+    uint32_t sendBurstNudge(CountingOutput &output, std::array<uint8_t, 1024> &buffer, int faderIndex, int value)
+    {
+        const auto hui = MidiEncoding::huiFaderMove(faderIndex, value);
+        const auto mcu = MidiEncoding::pitchWheel(faderIndex, value);
+
+        std::copy(hui.begin(), hui.end(), buffer.begin());
+        std::copy(mcu.begin(), mcu.end(), buffer.begin() + (std::ptrdiff_t)hui.size());
+
+        return output.send(buffer.data(), (int)(hui.size() + mcu.size()));
+    }
+
+    /**
+     * Feedback as a DAW sends it during automation playback, one message per
+     * entry the way the MIDI input callback receives them. Timed like a
+     * capture from Logic (MCU) and Pro Tools (HUI) playing back fader
+     * automation on 8 channels: positions and meters every 10 ms, the LCD
+     * and HUI scribble strips every 100 ms
+     */
+    struct FeedbackTrace
+    {
+        std::vector<uint8_t> bytes;
+        std::vector<std::pair<int, int>> messages; // Offset and size in bytes
+        double seconds = 0.0;
+
+        void add(std::initializer_list<uint8_t> message)
+        {
+            messages.emplace_back((int)bytes.size(), (int)message.size());
+            bytes.insert(bytes.end(), message);
+        }
+    };
+
+    FeedbackTrace makePlaybackTrace()
+    {
+        constexpr int numFrames = 100; // One second of 10 ms frames
+        FeedbackTrace trace;
+        trace.seconds = numFrames * 0.01;
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            for (int channel = 0; channel < FaderState::numFaders; ++channel)
+            {
+                // A slow fade per channel, with meters bouncing along
+                const int value = (frame * 160 + channel * 2000) & FaderState::maxValue;
+                const auto level = (uint8_t)((frame + channel * 3) % 13);
+
+                // MCU: pitch wheel position and channel pressure meter
+                trace.add({(uint8_t)(0xE0 | channel), (uint8_t)(value & 0x7F), (uint8_t)(value >> 7)});
+                trace.add({0xD0, (uint8_t)(channel << 4 | level)});
+
+                // HUI: position MSB and LSB, and poly aftertouch meter
+                trace.add({0xB0, (uint8_t)channel, (uint8_t)(value >> 7)});
+                trace.add({0xB0, (uint8_t)(0x20 | channel), (uint8_t)(value & 0x7F)});
+                trace.add({0xA0, (uint8_t)channel, level});
+            }
+
+            if (frame % 10 == 0)
+            {
+                // MCU LCD top row: header, offset 0, 56 characters
+                std::vector<uint8_t> lcd{0xF0, 0x00, 0x00, 0x66, 0x14, 0x12, 0x00};
+                for (int i = 0; i < 56; ++i)
+                    lcd.push_back((uint8_t)('A' + (frame / 10 + i) % 26));
+                lcd.push_back(0xF7);
+
+                trace.messages.emplace_back((int)trace.bytes.size(), (int)lcd.size());
+                trace.bytes.insert(trace.bytes.end(), lcd.begin(), lcd.end());
+
+                // HUI scribble strip for each channel: four characters
+                for (int channel = 0; channel < FaderState::numFaders; ++channel)
+                    trace.add({0xF0, 0x00, 0x00, 0x66, 0x05, 0x00, 0x10, (uint8_t)channel,
+                               (uint8_t)('A' + channel), 'u', 'd', (uint8_t)('0' + frame / 10), 0xF7});
+            }
+        }
+
+        return trace;
+    }
+
+    /** The decoder FaderEngine first had: one juce::MidiMessage per message, a search over the faders per controller */
+    uint32_t decodeLegacy(const juce::MidiMessage &message, std::array<int, FaderState::numFaders> &faderValues)
+    {
+        if (message.isNoteOff() && message.getVelocity() == 0 && message.getNoteNumber() == 0)
+            return 1;
+
+        if (message.isController())
+        {
+            const int controllerNumber = message.getControllerNumber();
+            const int value = message.getControllerValue();
+
+            for (int i = 0; i < FaderState::numFaders; ++i)
+            {
+                if (controllerNumber == i || controllerNumber == i + 32)
+                {
+                    int msb = faderValues[(size_t)i] >> 7;
+                    int lsb = faderValues[(size_t)i] & 0x7F;
+
+                    if (controllerNumber == i)
+                        msb = value & 0x7F;
+                    else
+                        lsb = value & 0x7F;
+
+                    faderValues[(size_t)i] = (msb << 7) | lsb;
+                    return (uint32_t)faderValues[(size_t)i];
+                }
+            }
+        }
+        else if (message.isPitchWheel())
+        {
+            const int channel = message.getChannel();
+            if (channel >= 1 && channel <= FaderState::numFaders)
+                faderValues[(size_t)channel - 1] = message.getPitchWheelValue();
+        }
+
+        return 0;
+    }
+
+    /** Keeps what the table-driven decoder reports, like a surface does minus the engine */
+    struct ReplayHandler : public MidiDecoder::Handler
+    {
+        void huiFaderByte(int faderIndex, bool isMsb, int value) override
+        {
+            auto &position = faderValues[(size_t)faderIndex];
+            position = isMsb ? (value << 7 | (position & 0x7F)) : ((position & ~0x7F) | value);
+        }
+
+        void pitchWheel(int channelIndex, int value) override
+        {
+            if (channelIndex < FaderState::numFaders)
+                faderValues[(size_t)channelIndex] = value;
+        }
+
+        void meterLevel(int channelIndex, int level) override { levels += (uint32_t)(channelIndex + level); }
+        void sysEx(const uint8_t *, int size) override { levels += (uint32_t)size; }
+
+        std::array<int, FaderState::numFaders> faderValues{};
+        uint32_t levels = 0;
+    };
+
+    /**
+     * A random message the way a MIDI driver delivers one: a status byte, the
+     * length that status calls for and 7-bit data. Controllers and sysex lean
+     * towards what the HUI and MCU decoders look at. Returns the size
+     */
+    int makeRandomMessage(juce::Random &random, std::array<uint8_t, 64> &data)
+    {
+        const int kind = random.nextInt(10);
+
+        if (kind == 0)
+        {
+            int size = 0;
+            data[(size_t)size++] = 0xF0;
+
+            // Mackie header half the time
+            if (random.nextBool())
+                for (const uint8_t byte : {0x00, 0x00, 0x66})
+                    data[(size_t)size++] = byte;
+
+            for (int i = random.nextInt(40); --i >= 0;)
+                data[(size_t)size++] = (uint8_t)random.nextInt(0x80);
+
+            data[(size_t)size++] = 0xF7;
+            return size;
+        }
+
+        const auto status = kind == 1 ? systemStatuses[(size_t)random.nextInt((int)systemStatuses.size())]
+                                      : (uint8_t)((0x80 + 0x10 * random.nextInt(7)) | (random.nextBool() ? 0 : random.nextInt(16)));
+        const int size = juce::MidiMessage::getMessageLengthFromFirstByte(status);
+
+        data[0] = status;
+        for (int i = 1; i < size; ++i)
+            data[(size_t)i] = (uint8_t)random.nextInt(0x80);
+
+        // Fader, zone and port controllers all sit below 0x30
+        if (size > 1 && random.nextBool())
+            data[1] = (uint8_t)random.nextInt(0x30);
+
+        return size;
+    }
+}
+
+// CONSTRUCTOR / DESTRUCTOR
+//==============================================================================
+EngineBench::EngineBench(FaderEngine &engineToDrive, int msPerCaseToRun, int numFuzzRoundsToRun, juce::int64 fuzzSeed,
+                         int msToStress)
+    : juce::Thread("Fader Keys Engine Bench"),
+      engine(engineToDrive),
+      msPerCase(msPerCaseToRun),
+      numFuzzRounds(numFuzzRoundsToRun),
+      seed(fuzzSeed),
+      msStress(msToStress)
+{
+    // The key event counter tells the bench when the engine thread has caught up
+    engine.setRecordingStats(true);
+
+    // The bench thread feeds the surfaces now, so a DAW on the real ports can't write alongside it
+    engine.detachMidiInputs();
+    startThread();
+}
+
+EngineBench::~EngineBench()
+{
+    stopThread(engineTimeoutMs);
+}
+
+bool EngineBench::isRequested(const juce::String &commandLine)
+{
+    return commandLine.contains(benchFlag) || commandLine.contains(fuzzFlag) || commandLine.contains(stressFlag);
+}
+
+std::unique_ptr<EngineBench> EngineBench::createFromCommandLine(FaderEngine &engine, const juce::String &commandLine)
+{
+    // --bench-engine [ms], --fuzz-engine [rounds] [seed], --stress-fader-state [ms]
+    const auto args = juce::StringArray::fromTokens(commandLine, true);
+    const int benchIndex = args.indexOf(benchFlag);
+    const int fuzzIndex = args.indexOf(fuzzFlag);
+    const int stressIndex = args.indexOf(stressFlag);
+
+    int msPerCase = 0;
+    if (benchIndex >= 0)
+    {
+        const int ms = args[benchIndex + 1].getIntValue();
+        msPerCase = ms > 0 ? ms : defaultMsPerCase;
+    }
+
+    int numFuzzRounds = 0;
+    juce::int64 seed = 0;
+    if (fuzzIndex >= 0)
+    {
+        const int rounds = args[fuzzIndex + 1].getIntValue();
+        numFuzzRounds = rounds > 0 ? rounds : defaultFuzzRounds;
+
+        const auto seedArg = args[fuzzIndex + 2];
+        seed = seedArg.containsOnly("0123456789") && seedArg.isNotEmpty() ? seedArg.getLargeIntValue()
+                                                                          : juce::Time::currentTimeMillis();
+    }
+
+    int msToStress = 0;
+    if (stressIndex >= 0)
+    {
+        const int ms = args[stressIndex + 1].getIntValue();
+        msToStress = ms > 0 ? ms : defaultMsToStress;
+    }
+
+    return std::make_unique<EngineBench>(engine, msPerCase, numFuzzRounds, seed, msToStress);
+}
+
+// BENCH THREAD
+//==============================================================================
+void EngineBench::run()
+{
+    int result = 0;
+
+    if (msPerCase > 0)
+    {
+        juce::Logger::writeToLog("Engine bench (" + juce::String(msPerCase) + " ms per case, "
+                                 + juce::String(engine.getNumSurfaces()) + " surfaces)");
+        benchEncoding();
+        benchNudge();
+        benchKeyDispatch();
+        benchDecoding();
+        benchFeedbackReplay();
+    }
+
+    if (numFuzzRounds > 0 && !fuzz())
+        result = 1;
+
+    if (msStress > 0 && !stressFaderState())
+        result = 1;
+
+    juce::MessageManager::callAsync([result] {
+        if (auto *app = juce::JUCEApplicationBase::getInstance())
+            app->setApplicationReturnValue(result);
+
+        juce::JUCEApplicationBase::quit();
+    });
+}
+
+void EngineBench::benchEncoding()
+{
+    timeCase("Encode HUI fader move", msPerCase, [](int i) {
+        return checksum(MidiEncoding::huiFaderMove(i & 0x07, i & FaderState::maxValue));
+    });
+
+    timeCase("Encode MCU pitch wheel", msPerCase, [](int i) {
+        return checksum(MidiEncoding::pitchWheel(i & 0x07, i & FaderState::maxValue));
+    });
+
+    timeCase("Encode bank bursts", msPerCase, [](int i) {
+        const auto &bursts = MidiEncoding::getBankBursts(static_cast<MidiEncoding::BankAction>(i & 0x03));
+        return checksum(bursts.mcu) + checksum(bursts.hui);
+    });
+}
+
+void EngineBench::benchNudge()
+{
+    // The same nudges through the old per-message path and the burst path, so the two lines compare directly
+    CountingOutput legacyOutput;
+    juce::int64 numLegacyNudges = 0;
+
+    timeCase("Nudge before (juce::MidiMessage per message)", msPerCase, [&](int i) {
+        ++numLegacyNudges;
+        return sendLegacyNudge(legacyOutput, i & 0x07, i & FaderState::maxValue);
+    });
+
+    legacyOutput.logPerNudge("Nudge before", numLegacyNudges);
+
+    CountingOutput burstOutput;
+    std::array<uint8_t, 1024> buffer{};
+    juce::int64 numBurstNudges = 0;
+
+    timeCase("Nudge after (bursts, one send)", msPerCase, [&](int i) {
+        ++numBurstNudges;
+        return sendBurstNudge(burstOutput, buffer, i & 0x07, i & FaderState::maxValue);
+    });
+
+    burstOutput.logPerNudge("Nudge after", numBurstNudges);
+}
+
+void EngineBench::benchKeyDispatch()
+{
+    const auto start = juce::Time::getHighResolutionTicks();
+    const auto end = start + juce::Time::getHighResolutionTicksPerSecond() * msPerCase / 1000;
+    juce::int64 numEvents = 0;
+
+    // Every fader up then down, so the faders end about where they started
+    while (juce::Time::getHighResolutionTicks() < end && !threadShouldExit())
+    {
+        for (const int keyCode : faderKeyCodes)
+        {
+            postKey(keyCode, true, 0);
+            postKey(keyCode, false, 0);
+        }
+
+        numEvents += 2 * (juce::int64)faderKeyCodes.size();
+    }
+
+    // Counts until the engine thread has handled the last one
+    if (!waitForEngine())
+        juce::Logger::writeToLog("Key dispatch: the engine thread didn't catch up");
+
+    logRate("Key dispatch (posted -> handled)", numEvents, juce::Time::getHighResolutionTicks() - start);
+}
+
+void EngineBench::benchDecoding()
+{
+    // Feedback to the first surface, as its MIDI input thread would deliver it
+    timeCase("Decode MCU pitch wheel", msPerCase, [this](int i) {
+        const auto message = MidiEncoding::pitchWheel(i & 0x07, i & FaderState::maxValue);
+        engine.injectMidiInput(0, message.data(), (int)message.size());
+        return (uint32_t)1;
+    });
+
+    timeCase("Decode HUI fader position (MSB + LSB)", msPerCase, [this](int i) {
+        const auto messages = MidiEncoding::huiPosition(i & 0x07, i & FaderState::maxValue);
+        engine.injectMidiInput(0, messages.data(), (int)MidiEncoding::messageSize);
+        engine.injectMidiInput(0, messages.data() + MidiEncoding::messageSize, (int)MidiEncoding::messageSize);
+        return (uint32_t)1;
+    });
+
+    // Meters are the bulk of a playing DAW's feedback, every channel several times a second
+    timeCase("Decode MCU meter (channel pressure)", msPerCase, [this](int i) {
+        const std::array<uint8_t, 2> message{0xD0, (uint8_t)((i & 0x07) << 4 | i % 13)};
+        engine.injectMidiInput(0, message.data(), (int)message.size());
+        return (uint32_t)1;
+    });
+
+    timeCase("Decode HUI meter (poly aftertouch)", msPerCase, [this](int i) {
+        const std::array<uint8_t, 3> message{0xA0, (uint8_t)(i & 0x07), (uint8_t)((i >> 3 & 0x01) << 4 | i % 13)};
+        engine.injectMidiInput(0, message.data(), (int)message.size());
+        return (uint32_t)1;
+    });
+}
+
+void EngineBench::benchFeedbackReplay()
+{
+    const auto trace = makePlaybackTrace();
+    const int numMessages = (int)trace.messages.size();
+    const double realTimeRate = numMessages / trace.seconds;
+
+    juce::Logger::writeToLog("Playback feedback trace: " + juce::String(numMessages) + " messages, "
+                             + juce::String(trace.bytes.size()) + " bytes per second of playback, "
+                             + juce::String(realTimeRate * 10.0, 0) + " messages/s at 10x real time");
+
+    // Before: JUCE builds a MidiMessage for every message the port delivers, sysex on the heap
+    std::array<int, FaderState::numFaders> legacyValues{};
+    int legacyIndex = 0;
+
+    const double legacyRate = timeCase("Replay feedback before (juce::MidiMessage)", msPerCase, [&](int) {
+        const auto [offset, size] = trace.messages[(size_t)legacyIndex];
+        legacyIndex = legacyIndex + 1 < numMessages ? legacyIndex + 1 : 0;
+
+        const juce::MidiMessage message(trace.bytes.data() + offset, size);
+        return decodeLegacy(message, legacyValues);
+    });
+
+    // After: the raw bytes straight into the table-driven decoder
+    ReplayHandler handler;
+    MidiDecoder decoder(handler);
+    int index = 0;
+
+    const double rate = timeCase("Replay feedback after (MidiDecoder)", msPerCase, [&](int) {
+        const auto [offset, size] = trace.messages[(size_t)index];
+        index = index + 1 < numMessages ? index + 1 : 0;
+
+        decoder.feed(trace.bytes.data() + offset, size);
+        return handler.levels;
+    });
+
+    juce::Logger::writeToLog("Replay feedback: before " + juce::String(legacyRate / realTimeRate, 0) + "x real time, after "
+                             + juce::String(rate / realTimeRate, 0) + "x real time ("
+                             + juce::String(rate / juce::jmax(1.0, legacyRate), 1) + "x faster)");
+
+    if (rate < realTimeRate * 10.0)
+        juce::Logger::writeToLog("Replay feedback: the decoder can't keep up with 10x real time");
+}
+
+// FUZZING
+//==============================================================================
+bool EngineBench::fuzz()
+{
+    juce::Logger::writeToLog("Engine fuzz (" + juce::String(numFuzzRounds) + " rounds, seed "
+                             + juce::String(seed) + ", " + juce::String(engine.getNumSurfaces()) + " surfaces)");
+
+    juce::Random random(seed);
+    std::array<uint8_t, 64> data{};
+
+    for (int round = 0; round < numFuzzRounds && !threadShouldExit(); ++round)
+    {
+        for (int i = 0; i < messagesPerRound; ++i)
+        {
+            const int size = makeRandomMessage(random, data);
+            engine.injectMidiInput(random.nextInt(engine.getNumSurfaces()), data.data(), size);
+        }
+
+        // Half the keys are fader keys, the rest anything, with any modifiers
+        for (int i = 0; i < keysPerRound; ++i)
+        {
+            const int keyCode = random.nextBool() ? faderKeyCodes[(size_t)random.nextInt((int)faderKeyCodes.size())]
+                                                  : random.nextInt(KeyBindings::numKeyCodes);
+            const int modifiers = random.nextInt((KeyModifiers::shift | KeyModifiers::option | KeyModifiers::control) + 1);
+
+            postKey(keyCode, random.nextBool(), modifiers, random.nextInt(8) == 0);
+        }
+
+        if (!waitForEngine())
+        {
+            juce::Logger::writeToLog("Fuzz round " + juce::String(round) + ": the engine thread stopped handling keys");
+            return false;
+        }
+
+        const auto problem = engine.checkConsistency(false);
+
+        if (problem.isNotEmpty())
+        {
+            juce::Logger::writeToLog("Fuzz round " + juce::String(round) + ": " + problem
+                                     + " (seed " + juce::String(seed) + ")");
+            return false;
+        }
+    }
+
+    // Every key up must leave nothing held or touched
+    for (int keyCode = 0; keyCode < KeyBindings::numKeyCodes; ++keyCode)
+        postKey(keyCode, false, 0);
+
+    const auto problem = waitForEngine() ? engine.checkConsistency(true)
+                                         : juce::String("the engine thread stopped handling keys");
+
+    if (problem.isNotEmpty())
+    {
+        juce::Logger::writeToLog("Fuzz, after releasing every key: " + problem + " (seed " + juce::String(seed) + ")");
+        return false;
+    }
+
+    juce::Logger::writeToLog("Fuzz passed, key, touch and bank state stayed consistent");
+    return true;
+}
+
+// FADER STATE STRESS
+//==============================================================================
+bool EngineBench::stressFaderState()
+{
+    juce::Logger::writeToLog("Fader state stress (" + juce::String(msStress) + " ms)");
+
+    // A state of its own, so the writer below is its only MIDI input thread
+    FaderState state;
+    std::atomic<bool> writerShouldStop{false};
+    std::array<uint32_t, FaderState::numFaders> numWrites{};
+    std::array<int, FaderState::numFaders> lastWritten{};
+
+    // Every position written has its MSB equal to its LSB, so a reader that sees
+    // them differ caught half of one write and half of another
+    auto writer = std::thread([&] {
+        for (uint32_t n = 0; !writerShouldStop.load(std::memory_order_relaxed); ++n)
+        {
+            const int fader = (int)(n % FaderState::numFaders);
+            const int half = (int)(n / FaderState::numFaders % 128);
+            const int value = half << 7 | half;
+
+            if (n / FaderState::numFaders % 2 == 0)
+            {
+                state.setFromFeedback(fader, value);
+            }
+            else
+            {
+                state.setHuiMsb(fader, half);
+                state.setHuiLsb(fader, half);
+            }
+
+            ++numWrites[(size_t)fader];
+            lastWritten[(size_t)fader] = value;
+        }
+    });
+
+    const auto end = juce::Time::getMillisecondCounter() + (juce::uint32)msStress;
+    std::array<uint32_t, FaderState::numFaders> lastCounts{};
+    juce::int64 numReads = 0;
+    bool passed = true;
+
+    while (passed && juce::Time::getMillisecondCounter() < end && !threadShouldExit())
+    {
+        for (int fader = 0; fader < FaderState::numFaders && passed; ++fader)
+        {
+            const auto count = state.getFeedbackCount(fader);
+            const int value = state.get(fader);
+            ++numReads;
+
+            if ((value >> 7) != (value & 0x7F))
+            {
+                juce::Logger::writeToLog("Fader " + juce::String(fader + 1) + " read torn: MSB " + juce::String(value >> 7)
+                                         + ", LSB " + juce::String(value & 0x7F));
+                passed = false;
+            }
+            else if (count < lastCounts[(size_t)fader])
+            {
+                juce::Logger::writeToLog("Fader " + juce::String(fader + 1) + " feedback count went back from "
+                                         + juce::String(lastCounts[(size_t)fader]) + " to " + juce::String(count));
+                passed = false;
+            }
+
+            lastCounts[(size_t)fader] = count;
+        }
+    }
+
+    writerShouldStop.store(true, std::memory_order_relaxed);
+    writer.join();
+
+    // Once the writer is done, every write must be counted and the last one must be what's left
+    for (int fader = 0; fader < FaderState::numFaders && passed; ++fader)
+    {
+        if (state.getFeedbackCount(fader) != numWrites[(size_t)fader] || state.get(fader) != lastWritten[(size_t)fader])
+        {
+            juce::Logger::writeToLog("Fader " + juce::String(fader + 1) + " lost a write: "
+                                     + juce::String(state.getFeedbackCount(fader)) + " of " + juce::String(numWrites[(size_t)fader])
+                                     + " counted, at " + juce::String(state.get(fader)) + " instead of "
+                                     + juce::String(lastWritten[(size_t)fader]));
+            passed = false;
+        }
+    }
+
+    if (passed)
+        juce::Logger::writeToLog("Fader state stress passed, " + juce::String(numReads) + " reads with no torn or lost values");
+
+    return passed;
+}
+
+// ENGINE
+//==============================================================================
+void EngineBench::postKey(int keyCode, bool isKeyDown, int modifiers, bool isRepeat)
+{
+    // The bench outruns the engine, so wait for queue space rather than drop keys
+    while (!engine.postKeyEvent(keyCode, isKeyDown, modifiers, isRepeat) && !threadShouldExit())
+        juce::Thread::yield();
+
+    ++numKeysPosted;
+}
+
+bool EngineBench::waitForEngine()
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32)engineTimeoutMs;
+
+    while (engine.getStats().getCount(EngineStats::Counter::KeyEvents) < numKeysPosted)
+    {
+        if (juce::Time::getMillisecondCounter() >= deadline || threadShouldExit())
+            return false;
+
+        juce::Thread::yield();
+    }
+
+    return true;
+}
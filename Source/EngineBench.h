@@ -0,0 +1,82 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "FaderEngine.h"
+
+/**
+ * Headless throughput benchmark and fuzzer for the engine's encode, key
+ * dispatch and MIDI decode paths. Needs no DAW, so it runs anywhere the
+ * app builds, including Linux.
+ *
+ * `--bench-engine [ms]` times each case for about that long (default 1000)
+ * and logs events per second and nanoseconds per event:
+ *  - encoding: HUI fader moves, MCU pitch wheel, bank bursts
+ *  - nudge: one fader nudge built and handed to the output the old way
+ *    (a juce::MidiMessage per message, 7 sends) and the burst way (one
+ *    send), with bytes and sends per nudge for each
+ *  - key dispatch: fader key events posted -> handled by the engine thread
+ *  - decoding: HUI and MCU fader feedback and meters through a surface's MIDI input
+ *  - feedback replay: one second of recorded-style automation playback
+ *    (positions, meters, LCD and scribble strip sysex) through the old
+ *    juce::MidiMessage decoder and MidiDecoder, as messages per second and
+ *    multiples of real time against a 10x target
+ *
+ * `--fuzz-engine [rounds] [seed]` feeds random MIDI messages and key
+ * sequences to every surface. After each round the engine thread checks
+ * its held keys, touches and bank cache agree with each other, and once
+ * every key is released that nothing is left held or touched; the run
+ * fails on the first mismatch. The seed is logged so a failing run can be
+ * repeated.
+ *
+ * The surfaces' real MIDI inputs are stopped for every mode, so the bench
+ * thread is the only one feeding their decoders.
+ *
+ * `--stress-fader-state [ms]` writes positions into a FaderState from one
+ * thread the way a surface's MIDI input does (setFromFeedback and HUI
+ * MSB/LSB pairs) while the bench thread reads them, and fails on a torn
+ * position, a feedback count going backwards or a lost write.
+ */
+class EngineBench : private juce::Thread
+{
+public:
+    EngineBench(FaderEngine &engineToDrive, int msPerCase, int numFuzzRounds, juce::int64 fuzzSeed, int msToStress);
+    ~EngineBench() override;
+
+    /** True if the command line asks for the benchmark or fuzzer instead of the normal app */
+    static bool isRequested(const juce::String &commandLine);
+
+    /** Builds a benchmark or fuzz run from the command line arguments */
+    static std::unique_ptr<EngineBench> createFromCommandLine(FaderEngine &engine, const juce::String &commandLine);
+
+private:
+    void run() override;
+
+    // Benchmark cases (bench thread)
+    void benchEncoding();
+    void benchNudge();
+    void benchKeyDispatch();
+    void benchDecoding();
+    void benchFeedbackReplay();
+
+    /** Runs the fuzz rounds. Returns false if the engine's bookkeeping went inconsistent */
+    bool fuzz();
+
+    /** Races a feedback writer against a reader. Returns false if a value was torn or lost */
+    bool stressFaderState();
+
+    /** Posts a key event, waiting for queue space rather than dropping it */
+    void postKey(int keyCode, bool isKeyDown, int modifiers, bool isRepeat = false);
+
+    /** Waits until the engine thread has handled every posted key event */
+    bool waitForEngine();
+
+    FaderEngine &engine;
+    const int msPerCase;
+    const int numFuzzRounds;
+    const juce::int64 seed;
+    const int msStress;
+
+    juce::int64 numKeysPosted = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EngineBench)
+};
@@ -0,0 +1,76 @@
+#include "EngineStats.h"
+
+namespace
+{
+    constexpr int statsWriteIntervalMs = 5000;
+
+    constexpr std::array<const char *, (size_t)EngineStats::Stage::numStages> STAGE_NAMES{
+        "Key queue", "Key handle", "MIDI send", "Key to MIDI", "MIDI in delivery", "MIDI in decode"};
+
+    constexpr std::array<const char *, (size_t)EngineStats::Counter::numCounters> COUNTER_NAMES{
+        "Key events", "Dropped key events", "Coalesced moves", "MIDI messages out", "MIDI bytes out",
+        "MIDI messages in", "MIDI bytes in"};
+}
+
+// STATS
+//==============================================================================
+void EngineStats::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled && !isEnabled())
+    {
+        for (auto &histogram : histograms)
+            histogram.reset();
+        for (auto &counter : counters)
+            counter.store(0, std::memory_order_relaxed);
+    }
+
+    enabled.store(shouldBeEnabled, std::memory_order_relaxed);
+}
+
+juce::String EngineStats::getReport() const
+{
+    juce::String report;
+
+    report << "Fader Keys stats " << juce::Time::getCurrentTime().toISO8601(true) << "\n\n";
+
+    for (size_t i = 0; i < histograms.size(); ++i)
+    {
+        const auto &histogram = histograms[i];
+        report << juce::String(STAGE_NAMES[i]).paddedRight(' ', 20)
+               << "n=" << histogram.getCount()
+               << " p50=" << histogram.getPercentileMicros(50.0)
+               << "us p99=" << histogram.getPercentileMicros(99.0)
+               << "us max=" << histogram.getPercentileMicros(100.0) << "us\n";
+    }
+
+    report << "\n";
+
+    for (size_t i = 0; i < counters.size(); ++i)
+        report << juce::String(COUNTER_NAMES[i]).paddedRight(' ', 20)
+               << counters[i].load(std::memory_order_relaxed) << "\n";
+
+    return report;
+}
+
+// STATS FILE
+//==============================================================================
+StatsFileWriter::StatsFileWriter(const EngineStats &statsToWrite, const juce::File &fileToWrite)
+    : stats(statsToWrite),
+      file(fileToWrite)
+{
+    startTimer(statsWriteIntervalMs);
+}
+
+StatsFileWriter::~StatsFileWriter()
+{
+    stopTimer();
+
+    // Keep the final numbers once recording stops
+    timerCallback();
+}
+
+void StatsFileWriter::timerCallback()
+{
+    if (!file.replaceWithText(stats.getReport()))
+        DBG("Failed to write stats file " << file.getFullPathName());
+}
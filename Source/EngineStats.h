@@ -0,0 +1,87 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "LatencyHistogram.h"
+
+/**
+ * Per-stage latency histograms and throughput counters for the key path
+ * (listener -> engine thread -> MIDI out) and the DAW feedback path
+ * (MIDI in -> decoder). Everything is lock-free. While disabled the hot
+ * paths only pay for one relaxed load and a branch.
+ */
+class EngineStats
+{
+public:
+    enum class Stage
+    {
+        KeyQueue,       // Key captured -> picked up by the engine thread
+        KeyHandle,      // Picked up -> fader moves queued
+        MidiSend,       // Block handed to the MIDI output
+        KeyToMidi,      // Key captured -> MIDI sent
+        MidiInDelivery, // MIDI driver timestamp -> input callback
+        MidiInDecode,   // Input callback -> fader state updated
+        numStages
+    };
+
+    enum class Counter
+    {
+        KeyEvents,
+        DroppedKeyEvents,
+        CoalescedMoves,
+        MidiMessagesOut,
+        MidiBytesOut,
+        MidiMessagesIn,
+        MidiBytesIn,
+        numCounters
+    };
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /** Turning recording on starts from empty histograms and counters */
+    void setEnabled(bool shouldBeEnabled);
+
+    void record(Stage stage, juce::int64 elapsedTicks)
+    {
+        histograms[(size_t)stage].record(elapsedTicks);
+    }
+
+    void recordMicros(Stage stage, double micros)
+    {
+        histograms[(size_t)stage].recordMicros(micros);
+    }
+
+    void add(Counter counter, juce::int64 amount = 1)
+    {
+        counters[(size_t)counter].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    const LatencyHistogram &getHistogram(Stage stage) const { return histograms[(size_t)stage]; }
+    juce::int64 getCount(Counter counter) const { return counters[(size_t)counter].load(std::memory_order_relaxed); }
+
+    /** Plain-text summary of every stage and counter */
+    juce::String getReport() const;
+
+private:
+    std::atomic<bool> enabled{false};
+    std::array<LatencyHistogram, (size_t)Stage::numStages> histograms;
+    std::array<std::atomic<juce::int64>, (size_t)Counter::numCounters> counters{};
+};
+
+//==============================================================================
+/** Rewrites a stats file with the current report every few seconds (message thread) */
+class StatsFileWriter : private juce::Timer
+{
+public:
+    StatsFileWriter(const EngineStats &statsToWrite, const juce::File &fileToWrite);
+    ~StatsFileWriter() override;
+
+private:
+    void timerCallback() override;
+
+    const EngineStats &stats;
+    const juce::File file;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StatsFileWriter)
+};
@@ -2,341 +2,1071 @@
 
 namespace
 {
-    // Nudge amounts for sensitivity levels
-    static const std::array<std::pair<int, int>, 3> NUDGE_VALUES{{
-        // Up, Down
-        {240, 160}, // Low - Approx 0.5dB movement
-        {384, 320}, // Medium - Approx 1.0dB movement
-        {704, 640}  // High - Approx 2.0dB movement
+    // Motion for sensitivity levels
+    static const std::array<MotionCurve::Profile, 3> MOTION_PROFILES{{
+        // TapUp, TapDown, TapDb, HoldDelay, StartSpeed, MaxSpeed, Ramp
+        {240, 160, 0.5, 0.25, 1000.0, 4000.0, 1.5}, // Low - Approx 0.5dB per tap, exactly on a measured taper
+        {384, 320, 1.0, 0.25, 2000.0, 8000.0, 1.5}, // Medium - Approx 1.0dB per tap, exactly on a measured taper
+        {704, 640, 2.0, 0.25, 4000.0, 16000.0, 1.5} // High - Approx 2.0dB per tap, exactly on a measured taper
     }};
 
-    struct KeyMapping
-    {
-        int keyCode;
-        int faderIndex;
-        bool isUpward;
-    };
-
-    // Global keycode to fader mapping
-    static const std::array<KeyMapping, 16> KEY_FADER_MAP{{
-        // KeyCode, FaderIndex, IsUpward
-        // Fader 1 controls
-        {12, 0, true}, // Q - Fader 1 Up
-        {0, 0, false}, // A - Fader 1 Down
-        // Fader 2 controls
-        {13, 1, true}, // W - Fader 2 Up
-        {1, 1, false}, // S - Fader 2 Down
-        // Fader 3 controls
-        {14, 2, true}, // E - Fader 3 Up
-        {2, 2, false}, // D - Fader 3 Down
-        // Fader 4 controls
-        {15, 3, true}, // R - Fader 4 Up
-        {3, 3, false}, // F - Fader 4 Down
-        // Fader 5 controls
-        {17, 4, true}, // T - Fader 5 Up
-        {5, 4, false}, // G - Fader 5 Down
-        // Fader 6 controls
-        {16, 5, true}, // Y - Fader 6 Up
-        {4, 5, false}, // H - Fader 6 Down
-        // Fader 7 controls
-        {32, 6, true},  // U - Fader 7 Up
-        {38, 6, false}, // J - Fader 7 Down
-        // Fader 8 controls
-        {34, 7, true},  // I - Fader 8 Up
-        {40, 7, false}, // K - Fader 8 Down
-    }};
+    // Which of a fader's two keys are held
+    constexpr uint8_t upKeyBit = 0x01;
+    constexpr uint8_t downKeyBit = 0x02;
+
+    // How long moves on a banked-in fader with no cached position wait for the DAW's feedback
+    constexpr int bankFeedbackTimeoutMs = 100;
+
+    static_assert(SceneSnapshots::maxFaders >= FaderEngine::maxSurfaces * FaderState::numFaders,
+                  "A snapshot holds every fader");
 }
 
 // CONSTRUCTOR / DESTRUCTOR
 //==============================================================================
-FaderEngine::FaderEngine()
+FaderEngine::FaderEngine(int numSurfaces, bool useMidi2)
+    : juce::Thread("Fader Keys Engine"),
+      midi2Enabled(useMidi2)
 {
-    setupMidiDevices();
+    numSurfaces = juce::jlimit(1, maxSurfaces, numSurfaces);
+
+    for (int i = 0; i < numSurfaces; ++i)
+        surfaces.push_back(std::make_unique<FaderSurface>(i, stats, traceRecorder, useMidi2));
+
+    // Per-fader state is sized once here, nothing grows on the key path
+    numFaders = numSurfaces * FaderState::numFaders;
+    faderMotion.resize((size_t)numFaders);
+    heldFaderKeys.resize((size_t)numFaders);
+    touchedOutputs.resize((size_t)numFaders);
+    pendingMoves.resize((size_t)numFaders);
+    recallTouchedOutputs.resize((size_t)numFaders);
+    ramps.resize((size_t)numFaders);
+    bankFeedbackWaits.resize((size_t)numFaders);
+    bankPositionCache.fill(-1);
+    startThread(juce::Thread::Priority::highest);
 }
 
 FaderEngine::~FaderEngine()
 {
-    closeMidiDevices();
+    stopThread(1000);
+    releaseAllFaders();
+    statsWriter.reset();
+    traceRecorder.stop();
 }
 
-// MIDI DEVICE SETUP / TEARDOWN
+// INSTRUMENTATION
 //==============================================================================
-void FaderEngine::setupMidiDevices()
+void FaderEngine::setRecordingStats(bool shouldRecord)
 {
-    midiOutput = juce::MidiOutput::createNewDevice("Fader Keys MIDI Output");
-    if (midiOutput == nullptr)
-        DBG("Failed to create virtual MIDI output device");
+    stats.setEnabled(shouldRecord);
 
-    midiInput = juce::MidiInput::createNewDevice("Fader Keys MIDI Input", this);
-    if (midiInput == nullptr)
-    {
-        DBG("Failed to create virtual MIDI input device");
-    }
+    if (shouldRecord && statsFile != juce::File())
+        statsWriter = std::make_unique<StatsFileWriter>(stats, statsFile);
     else
+        statsWriter.reset();
+}
+
+juce::String FaderEngine::checkConsistency(bool expectAllReleased)
+{
+    isConsistencyChecked.store(false);
+    consistencyRequest.store(expectAllReleased ? 2 : 1, std::memory_order_release);
+    notify();
+
+    const auto deadline = juce::Time::getMillisecondCounter() + 5000;
+
+    while (!isConsistencyChecked.load(std::memory_order_acquire))
     {
-        midiInput->start();
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return "the engine thread didn't run the check";
+
+        juce::Thread::yield();
     }
+
+    return consistencyProblem;
 }
 
-void FaderEngine::closeMidiDevices()
+juce::String FaderEngine::findInconsistency(bool expectAllReleased) const
 {
-    if (midiInput != nullptr)
+    const auto fader = [](int faderIndex) { return "fader " + juce::String(faderIndex + 1); };
+    int numHeld = 0;
+
+    for (int i = 0; i < numFaders; ++i)
+    {
+        if (heldFaderKeys[(size_t)i] != 0)
+            ++numHeld;
+
+        if (expectAllReleased && heldFaderKeys[(size_t)i] != 0)
+            return fader(i) + " is still held with every key up";
+
+        // Hold-to-touch lets go when the last key on a fader does, so a touch outlives no key
+        if (touchedOutputs[(size_t)i] != 0 && heldFaderKeys[(size_t)i] == 0)
+            return fader(i) + " is still touched with no key holding it";
+    }
+
+    if (numHeld != numHeldFaders)
+        return juce::String(numHeld) + " faders are held but numHeldFaders is " + juce::String(numHeldFaders);
+
+    for (int keyCode = 0; keyCode < KeyBindings::numKeyCodes; ++keyCode)
     {
-        midiInput->stop();
-        midiInput.reset();
+        const auto &heldKey = heldKeys[(size_t)keyCode];
+
+        if (expectAllReleased && heldKey.faderMask != 0)
+            return "key " + juce::String(keyCode) + " still holds faders after its key up";
+
+        if (numFaders < 32 && (heldKey.faderMask >> numFaders) != 0)
+            return "key " + juce::String(keyCode) + " holds a fader past the last surface";
     }
-    midiOutput.reset();
+
+    if (bankOffset < 0 || bankOffset > maxCachedTracks - numFaders)
+        return "bank offset " + juce::String(bankOffset) + " is outside the track cache";
+
+    for (int track = 0; track < maxCachedTracks; ++track)
+    {
+        const int position = bankPositionCache[(size_t)track];
+
+        if (position < -1 || position > FaderState::maxValue)
+            return "track " + juce::String(track + 1) + " has cached position " + juce::String(position);
+    }
+
+    return {};
 }
 
-// INCOMING MIDI MESSAGE HANDLING
+// GLOBAL KEYCODE HANDLING
 //==============================================================================
-void FaderEngine::handleIncomingMidiMessage(juce::MidiInput *,
-                                            const juce::MidiMessage &message)
+bool FaderEngine::postKeyEvent(int keyCode, bool isKeyDown, int modifiers, bool isRepeat, juce::int64 timestampTicks)
 {
-    // Pro Tools's ping
-    if (message.isNoteOff() && message.getVelocity() == 0 && message.getNoteNumber() == 0)
+    const KeyEvent event{keyCode, isKeyDown, isRepeat, modifiers,
+                         timestampTicks != 0 ? timestampTicks : juce::Time::getHighResolutionTicks()};
+
+    if (!keyEvents.push(event))
     {
-        if (midiOutput != nullptr)
-            midiOutput->sendMessageNow(juce::MidiMessage::noteOn(1, 0, (uint8_t)127));
-        return;
+        stats.add(EngineStats::Counter::DroppedKeyEvents);
+        return false;
     }
 
-    // Pro Tools HUI messages
-    if (message.isController())
+    notify();
+    return true;
+}
+
+void FaderEngine::run()
+{
+    while (!threadShouldExit())
     {
-        int controllerNumber = message.getControllerNumber();
-        int value = message.getControllerValue();
+        // Collect everything the listener has queued, merging fader moves per fader
+        const bool isRecordingStats = stats.isEnabled();
+        const auto wakeTicks = isRecordingStats ? juce::Time::getHighResolutionTicks() : 0;
 
-        // HUI uses CC 0-7 for MSB and 32-39 for LSB
-        for (int i = 0; i < numFaders; ++i)
+        std::array<juce::int64, KeyEventQueue::capacity> keyDownTimes;
+        size_t numKeyDowns = 0;
+        int numEvents = 0;
+
+        KeyEvent event;
+        while (keyEvents.pop(event))
         {
-            int msbCC = i;
-            int lsbCC = i + 32;
+            handleGlobalKeycode(event.keyCode, event.isKeyDown, event.modifiers, event.isRepeat);
+            ++numEvents;
 
-            if (controllerNumber == msbCC || controllerNumber == lsbCC)
-            {
-                int msb = faderValues[i] >> 7;
-                int lsb = faderValues[i] & 0x7F;
+            if (event.isKeyDown && !event.isRepeat && numKeyDowns < keyDownTimes.size())
+                keyDownTimes[numKeyDowns++] = event.timestampTicks;
+        }
 
-                if (controllerNumber == msbCC)
-                    msb = value & 0x7F;
-                else
-                    lsb = value & 0x7F;
+        const int msUntilNextTick = advanceHeldFaders();
+        const auto handledTicks = isRecordingStats ? juce::Time::getHighResolutionTicks() : 0;
 
-                int newValue = (msb << 7) | lsb;
-                faderValues[i] = newValue;
+        // Recall messages go out in the same block as this pass's moves
+        const int msUntilNextRecall = advanceRecall();
+        const int msUntilNextRamp = advanceRamps();
+        const int msUntilNextMove = flushPendingMoves();
 
-                break;
+        // The bookkeeping is only settled between passes
+        if (const int request = consistencyRequest.exchange(0, std::memory_order_acquire); request != 0)
+        {
+            consistencyProblem = findInconsistency(request == 2);
+            isConsistencyChecked.store(true, std::memory_order_release);
+        }
+
+        if (isRecordingStats && numEvents > 0)
+        {
+            const auto sentTicks = juce::Time::getHighResolutionTicks();
+
+            stats.add(EngineStats::Counter::KeyEvents, numEvents);
+            stats.record(EngineStats::Stage::KeyHandle, handledTicks - wakeTicks);
+
+            for (size_t i = 0; i < numKeyDowns; ++i)
+            {
+                stats.record(EngineStats::Stage::KeyQueue, wakeTicks - keyDownTimes[i]);
+                stats.record(EngineStats::Stage::KeyToMidi, sentTicks - keyDownTimes[i]);
             }
         }
+
+        // Sleep until the next key event, motion tick, rate-limited move, recall message or ramp point
+        int msToWait = -1;
+
+        for (const int ms : {msUntilNextTick, msUntilNextMove, msUntilNextRecall, msUntilNextRamp})
+            if (ms >= 0 && (msToWait < 0 || ms < msToWait))
+                msToWait = ms;
+
+        wait(msToWait);
+    }
+}
+
+void FaderEngine::handleGlobalKeycode(int keyCode, bool isKeyDown, int modifiers, bool isRepeat)
+{
+    traceRecorder.recordKey(keyCode, isKeyDown, modifiers, isRepeat);
+
+    // A held fader key is released as it was pressed, even if the
+    // key map changed in between (e.g. focus moved to another DAW)
+    if (!isKeyDown && keyCode >= 0 && keyCode < KeyBindings::numKeyCodes)
+    {
+        auto &heldKey = heldKeys[(size_t)keyCode];
+
+        if (heldKey.faderMask != 0)
+        {
+            for (int i = 0; i < numFaders; ++i)
+                if (heldKey.faderMask & (1u << i))
+                    releaseFaderKey(i, heldKey.keyBit);
+
+            heldKey = {};
+            return;
+        }
     }
 
-    // Logic pitch wheel messages
-    else if (message.isPitchWheel())
+    const auto &action = keyMap.lookup(keyCode);
+    const bool isShiftDown = (modifiers & KeyModifiers::shift) != 0;
+
+    switch (action.type)
     {
-        int channel = message.getChannel();
-        if (channel >= 1 && channel <= numFaders)
+    case KeyAction::Type::Bank:
+        if (isKeyDown)
+        {
+            // The faders are about to show other tracks
+            stopAllRamps();
+            nudgeBank(isShiftDown ? action.shiftedBank : action.bank);
+        }
+        break;
+
+    case KeyAction::Type::Snapshot:
+        if (!isKeyDown || isRepeat)
+            break;
+
+        if (isShiftDown)
         {
-            faderValues[channel - 1] = message.getPitchWheelValue();
+            storeSnapshot(action.snapshotSlot);
         }
+        else
+        {
+            stopAllRamps();
+            startRecall(action.snapshotSlot);
+        }
+        break;
+
+    case KeyAction::Type::Ramp:
+    {
+        if (!isKeyDown || isRepeat)
+            break;
+
+        int faderIndex = lastFaderIndex;
+
+        if (action.faderIndex != KeyAction::lastFaderKey)
+        {
+            const int surfaceIndex = getSurfaceForModifiers(modifiers);
+            if (surfaceIndex < 0)
+                break;
+
+            faderIndex = surfaceIndex * FaderState::numFaders + action.faderIndex;
+        }
+
+        startRamps(getFadersToMove(faderIndex), action.rampTargetDb, action.rampDurationMs, action.rampShape);
+        break;
+    }
+
+    case KeyAction::Type::FaderUp:
+    case KeyAction::Type::FaderDown:
+    {
+        // Held keys are moved by the engine, so OS autorepeat is ignored
+        if (!isKeyDown || isRepeat)
+            break;
+
+        const int surfaceIndex = getSurfaceForModifiers(modifiers);
+        if (surfaceIndex < 0)
+            break;
+
+        // A key down for a key that's still held means its key up was lost, so let go of what it held
+        auto &heldKey = heldKeys[(size_t)keyCode];
+
+        for (int i = 0; i < numFaders; ++i)
+            if (heldKey.faderMask & (1u << i))
+                releaseFaderKey(i, heldKey.keyBit);
+
+        // Every fader in the gesture is touched and moved in the same handler call,
+        // so their messages go out together in one block per surface
+        heldKey.faderMask = getFadersToMove(surfaceIndex * FaderState::numFaders + action.faderIndex);
+        heldKey.keyBit = action.type == KeyAction::Type::FaderUp ? upKeyBit : downKeyBit;
+        lastFaderIndex = surfaceIndex * FaderState::numFaders + action.faderIndex;
+
+        for (int i = 0; i < numFaders; ++i)
+            if (heldKey.faderMask & (1u << i))
+                pressFaderKey(i, heldKey.keyBit, isShiftDown);
+        break;
+    }
+
+    case KeyAction::Type::None:
+    default:
+        break;
     }
 }
 
-// GLOBAL KEYCODE HANDLING
+int FaderEngine::getSurfaceForModifiers(int modifiers) const
+{
+    // No modifier: surface 1, Option: 2, Control: 3, Option + Control: 4
+    const int layer = ((modifiers & KeyModifiers::option) != 0 ? 1 : 0)
+                      + ((modifiers & KeyModifiers::control) != 0 ? 2 : 0);
+
+    return layer < getNumSurfaces() ? layer : -1;
+}
+
+uint32_t FaderEngine::getFadersToMove(int faderIndex) const
+{
+    const uint32_t fader = 1u << faderIndex;
+    const uint32_t group = groupEnabled.load() ? faderGroup.load() : 0;
+
+    // Bits past the last surface are ignored by every loop over the faders
+    return (group & fader) != 0 ? group : fader;
+}
+
+uint32_t FaderEngine::parseFaderGroup(const juce::String &faderNumbers)
+{
+    uint32_t group = 0;
+
+    for (const auto &number : juce::StringArray::fromTokens(faderNumbers, ", ", ""))
+    {
+        const int faderIndex = number.getIntValue() - 1;
+        if (faderIndex >= 0 && faderIndex < maxSurfaces * FaderState::numFaders)
+            group |= 1u << faderIndex;
+    }
+
+    return group;
+}
+
+juce::String FaderEngine::formatFaderGroup(uint32_t group)
+{
+    juce::StringArray faderNumbers;
+
+    for (int i = 0; i < maxSurfaces * FaderState::numFaders; ++i)
+        if (group & (1u << i))
+            faderNumbers.add(juce::String(i + 1));
+
+    return faderNumbers.joinIntoString(" ");
+}
+
+const MotionCurve::Profile &FaderEngine::getMotionProfile(bool isShiftDown) const
+{
+    // Use High sensitivity if shift is pressed, otherwise the current sensitivity
+    const auto profileSensitivity = isShiftDown ? NudgeSensitivity::High : sensitivity.load();
+    return MOTION_PROFILES[static_cast<size_t>(profileSensitivity)];
+}
+
+// FADER TOUCH
 //==============================================================================
+void FaderEngine::pressFaderKey(int faderIndex, uint8_t keyBit, bool isShiftDown)
+{
+    const bool wasHeld = heldFaderKeys[(size_t)faderIndex] != 0;
+    heldFaderKeys[(size_t)faderIndex] |= keyBit;
+
+    // A fresh press restarts the fine-to-coarse ramp
+    auto &motion = faderMotion[(size_t)faderIndex];
+    motion.pressedTicks = juce::Time::getHighResolutionTicks();
+    motion.isCoarse = isShiftDown;
+    motion.remainder = 0.0;
+
+    if (!wasHeld)
+        ++numHeldFaders;
+
+    // The key wins over a recall or ramp still working on this fader
+    const auto handedOver = (uint8_t)(takeOverRecall(faderIndex) | takeOverRamp(faderIndex));
+
+    if (handedOver != 0)
+    {
+        // The DAW already sees the fader touched, so a hold-to-touch press keeps that touch
+        // instead of sending another one. Otherwise it's let go before the key moves it
+        if (holdToTouch.load() && touchedOutputs[(size_t)faderIndex] == 0)
+            touchedOutputs[(size_t)faderIndex] = handedOver;
+        else
+            addReleaseToOutput(faderIndex, handedOver);
+    }
 
-void FaderEngine::handleGlobalKeycode(int keyCode, bool isKeyDown, bool isShiftDown)
+    // Touch on the first key down only, autorepeat just moves the fader
+    if (holdToTouch.load() && touchedOutputs[(size_t)faderIndex] == 0)
+    {
+        const auto outputs = getSurface(faderIndex).getActiveOutputs();
+        addTouchToOutput(faderIndex, outputs);
+        touchedOutputs[(size_t)faderIndex] = outputs;
+    }
+
+    // Every press moves by one fine tap step straight away. Exact dB steps only where the DAW's
+    // taper has been measured, the built-in tapers are too rough near the bottom of the fader
+    const auto &profile = getMotionProfile(isShiftDown);
+    const auto *dawProfile = activeProfile.load(std::memory_order_acquire);
+
+    if (dawProfile != nullptr && dawProfile->isTaperMeasured)
+        nudgeFaderTap(faderIndex, keyBit == upKeyBit ? 1 : -1, profile.tapDb);
+    else
+        nudgeFader(faderIndex, keyBit == upKeyBit ? profile.tapUp : -profile.tapDown);
+}
+
+void FaderEngine::releaseFaderKey(int faderIndex, uint8_t keyBit)
 {
-    if (!isKeyDown)
-        return;
+    const bool wasHeld = heldFaderKeys[(size_t)faderIndex] != 0;
+    heldFaderKeys[(size_t)faderIndex] &= (uint8_t)~keyBit;
 
-    if (handleBankSwitching(keyCode, isShiftDown))
+    if (heldFaderKeys[(size_t)faderIndex] != 0)
         return;
 
-    // Get movement amounts based on current sensitivity or shift override
-    const auto &nudgeAmounts = isShiftDown ? NUDGE_VALUES[static_cast<int>(NudgeSensitivity::High)] : // Use High sensitivity if shift is pressed
-                                   NUDGE_VALUES[static_cast<int>(sensitivity)];                       // Otherwise use current sensitivity
+    if (wasHeld)
+        --numHeldFaders;
 
-    // Look for matching fader control
-    for (const auto &mapping : KEY_FADER_MAP)
+    if (touchedOutputs[(size_t)faderIndex] != 0)
     {
-        if (mapping.keyCode == keyCode)
-        {
-            const int delta = mapping.isUpward ? nudgeAmounts.first : -nudgeAmounts.second;
-            nudgeFader(mapping.faderIndex, delta);
-            return;
-        }
+        // Land any move still held back by the rate limit before letting go
+        queuePendingMove(faderIndex, juce::Time::getHighResolutionTicks());
+        addReleaseToOutput(faderIndex, touchedOutputs[(size_t)faderIndex]);
+        touchedOutputs[(size_t)faderIndex] = 0;
     }
 }
 
+void FaderEngine::addTouchToOutput(int faderIndex, uint8_t outputs)
+{
+    auto &surface = getSurface(faderIndex);
+    const int localFader = getLocalFader(faderIndex);
+
+    if (outputs & FaderSurface::huiOutput)
+        surface.addToOutput(MidiEncoding::huiTouch(localFader));
+    if (outputs & FaderSurface::mcuOutput)
+        surface.addToOutput(MidiEncoding::mcuTouch(localFader));
+    if (outputs & FaderSurface::umpOutput)
+        surface.addToOutput(UmpEncoding::mcuTouch(localFader));
+}
+
+void FaderEngine::addPositionToOutput(int faderIndex, uint8_t outputs, int value)
+{
+    // For a fader that is already touched on these protocols
+    auto &surface = getSurface(faderIndex);
+    const int localFader = getLocalFader(faderIndex);
+
+    if (outputs & FaderSurface::huiOutput)
+        surface.addToOutput(MidiEncoding::huiPosition(localFader, value));
+    if (outputs & FaderSurface::mcuOutput)
+        surface.addToOutput(MidiEncoding::pitchWheel(localFader, value));
+    if (outputs & FaderSurface::umpOutput)
+        surface.addToOutput(UmpEncoding::pitchBend(localFader, value));
+}
+
+void FaderEngine::addReleaseToOutput(int faderIndex, uint8_t outputs)
+{
+    // Release through whichever protocols were touched, even if detection has changed since
+    auto &surface = getSurface(faderIndex);
+    const int localFader = getLocalFader(faderIndex);
+
+    if (outputs & FaderSurface::huiOutput)
+        surface.addToOutput(MidiEncoding::huiRelease(localFader));
+    if (outputs & FaderSurface::mcuOutput)
+        surface.addToOutput(MidiEncoding::mcuRelease(localFader));
+    if (outputs & FaderSurface::umpOutput)
+        surface.addToOutput(UmpEncoding::mcuRelease(localFader));
+}
+
+void FaderEngine::releaseAllFaders()
+{
+    numHeldFaders = 0;
+    heldKeys.fill({});
+    numRecallSteps = 0;
+    nextRecallStep = 0;
+
+    for (int i = 0; i < numFaders; ++i)
+    {
+        heldFaderKeys[(size_t)i] = 0;
+
+        const auto outputs = touchedOutputs[(size_t)i] | takeOverRecall(i) | takeOverRamp(i);
+        if (outputs != 0)
+            addReleaseToOutput(i, (uint8_t)outputs);
+
+        touchedOutputs[(size_t)i] = 0;
+    }
+
+    sendOutput();
+}
+
 // FADER MOVEMENT
 //==============================================================================
+int FaderEngine::advanceHeldFaders()
+{
+    const auto now = juce::Time::getHighResolutionTicks();
+    const double elapsedSeconds = juce::Time::highResolutionTicksToSeconds(now - lastMotionTicks);
+    lastMotionTicks = now;
+
+    if (numHeldFaders == 0)
+        return -1;
+
+    const auto *dawProfile = activeProfile.load(std::memory_order_acquire);
+    const auto shape = dawProfile != nullptr && dawProfile->accelerationCurve.has_value() ? *dawProfile->accelerationCurve
+                                                                                          : accelerationCurve.load();
+
+    for (int i = 0; i < numFaders; ++i)
+    {
+        const auto held = heldFaderKeys[(size_t)i];
+
+        // Nothing held, or up and down cancel out
+        if (held == 0 || held == (upKeyBit | downKeyBit))
+            continue;
+
+        auto &motion = faderMotion[(size_t)i];
+        const auto &motionProfile = getMotionProfile(motion.isCoarse);
+        const double heldSeconds = juce::Time::highResolutionTicksToSeconds(now - motion.pressedTicks);
+
+        if (heldSeconds < motionProfile.holdDelaySeconds)
+            continue;
+
+        // Only the part of this tick that falls after the hold delay counts
+        const double movingSeconds = juce::jmin(elapsedSeconds, heldSeconds - motionProfile.holdDelaySeconds);
+        const double speed = MotionCurve::speedAt(motionProfile, shape, heldSeconds - motionProfile.holdDelaySeconds);
+        const double steps = speed * movingSeconds + motion.remainder;
+        const int wholeSteps = (int)steps;
+        motion.remainder = steps - wholeSteps;
+
+        if (wholeSteps != 0)
+            nudgeFader(i, held == upKeyBit ? wholeSteps : -wholeSteps);
+    }
+
+    // Tick at the output rate so every held fader moves on each send slot
+    return juce::jmax(1, 1000 / juce::jmax(1, maxMoveRateHz.load()));
+}
+
 void FaderEngine::nudgeFader(int faderIndex, int delta)
 {
-    // Validate fader index and MIDI output
-    if (faderIndex < 0 || faderIndex >= numFaders || midiOutput == nullptr)
+    // Validate fader index
+    if (faderIndex < 0 || faderIndex >= numFaders)
+    {
+        DBG("Invalid fader move: index=" << faderIndex);
+        return;
+    }
+
+    // Merge with any move still waiting for this fader's next send slot
+    auto &pending = pendingMoves[(size_t)faderIndex];
+
+    if (pending.hasMove() && stats.isEnabled())
+        stats.add(EngineStats::Counter::CoalescedMoves);
+    pending.delta = juce::jlimit(-16383, 16383, pending.delta + delta);
+}
+
+void FaderEngine::nudgeFaderTap(int faderIndex, int numSteps, double stepDb)
+{
+    // Validate fader index
+    if (faderIndex < 0 || faderIndex >= numFaders)
+    {
+        DBG("Invalid fader tap: index=" << faderIndex);
+        return;
+    }
+
+    // Taps merge by count, the latest step size wins
+    auto &pending = pendingMoves[(size_t)faderIndex];
+
+    if (pending.hasMove() && stats.isEnabled())
+        stats.add(EngineStats::Counter::CoalescedMoves);
+    pending.tapSteps += numSteps;
+    pending.tapDb = stepDb;
+}
+
+const FaderTaper &FaderEngine::getTaper(const FaderSurface &surface) const
+{
+    const auto *profile = activeProfile.load(std::memory_order_acquire);
+    if (profile != nullptr && profile->taper != nullptr)
+        return *profile->taper;
+
+    return surface.getDetectedProtocol() == ControlProtocol::Hui ? FaderTaper::getProTools()
+                                                                  : FaderTaper::getMackie();
+}
+
+int FaderEngine::flushPendingMoves()
+{
+    cacheBankFeedback();
+
+    const auto now = juce::Time::getHighResolutionTicks();
+    const uint32_t group = groupEnabled.load() ? faderGroup.load() : 0;
+    juce::int64 nextDueTicks = -1;
+
+    for (int i = 0; i < numFaders; ++i)
+    {
+        const auto &pending = pendingMoves[(size_t)i];
+
+        if (!pending.hasMove())
+            continue;
+
+        // Rate limited: leave the delta to accumulate until this fader's next slot
+        if (now < pending.nextSendTicks)
+        {
+            if (nextDueTicks < 0 || pending.nextSendTicks < nextDueTicks)
+                nextDueTicks = pending.nextSendTicks;
+            continue;
+        }
+
+        // Just banked to a track with no known position: the move is worked out once the DAW sends one
+        if (isWaitingForBankFeedback((group & (1u << i)) != 0 ? group : 1u << i, now))
+        {
+            const auto pollTicks = now + juce::Time::getHighResolutionTicksPerSecond() / 1000;
+            if (nextDueTicks < 0 || pollTicks < nextDueTicks)
+                nextDueTicks = pollTicks;
+            continue;
+        }
+
+        if ((group & (1u << i)) == 0)
+        {
+            queuePendingMove(i, now);
+            continue;
+        }
+
+        // A grouped fader takes the rest of its group along, so the group stays on one send slot
+        for (int member = 0; member < numFaders; ++member)
+            if (group & (1u << member))
+                queuePendingMove(member, now);
+    }
+
+    // Every fader that was due goes out in one block per surface (one packet on macOS)
+    sendOutput();
+
+    if (nextDueTicks < 0)
+        return -1;
+
+    return juce::jmax(1, (int)std::ceil(juce::Time::highResolutionTicksToSeconds(nextDueTicks - now) * 1000.0));
+}
+
+void FaderEngine::queuePendingMove(int faderIndex, juce::int64 now)
+{
+    auto &pending = pendingMoves[(size_t)faderIndex];
+
+    if (!pending.hasMove())
+        return;
+
+    // Banked to a track the DAW never sent a position for, moving from the old track's would jump it
+    if (!bankFeedbackWaits[(size_t)faderIndex].hasPosition)
     {
-        DBG("Invalid fader move: index=" << faderIndex
-                                         << " output=" << (midiOutput != nullptr ? "yes" : "no"));
+        pending.delta = 0;
+        pending.tapSteps = 0;
         return;
     }
 
-    // Calculate new value and limit to valid range (0-16383)
-    int newValue = faderValues[faderIndex] + delta;
-    newValue = juce::jlimit(0, 16383, newValue);
+    auto &surface = getSurface(faderIndex);
+    auto &faderState = surface.getFaderState();
+    const int localFader = getLocalFader(faderIndex);
+
+    // Taps land on exact dB steps of the DAW's taper, held motion adds raw steps on top
+    const int currentValue = faderState.get(localFader);
+    const int tappedValue = getTaper(surface).nudge(currentValue, pending.tapDb, pending.tapSteps);
+    const int newValue = juce::jlimit(0, FaderState::maxValue, tappedValue + pending.delta);
+    pending.delta = 0;
+    pending.tapSteps = 0;
+
+    // Already at the limit, nothing would move
+    if (newValue == currentValue)
+        return;
 
     // Store the new value
-    faderValues[faderIndex] = newValue;
+    faderState.set(localFader, newValue);
 
-    const auto huiMessages = createFaderMoveMessages(faderIndex, newValue);
-    const auto pitchWheelMessage = createPitchWheelMessage(faderIndex, newValue);
+    // A held fader is already touched, so only its position changes
+    const auto outputs = surface.getActiveOutputs();
 
-    // Send both HUI and pitch wheel messages
-    for (const auto &msg : huiMessages)
+    if (outputs & FaderSurface::huiOutput)
     {
-        midiOutput->sendMessageNow(msg);
+        if (touchedOutputs[(size_t)faderIndex] & FaderSurface::huiOutput)
+            surface.addToOutput(MidiEncoding::huiPosition(localFader, newValue));
+        else
+            surface.addToOutput(MidiEncoding::huiFaderMove(localFader, newValue));
     }
-    midiOutput->sendMessageNow(pitchWheelMessage);
+
+    if (outputs & FaderSurface::mcuOutput)
+        surface.addToOutput(MidiEncoding::pitchWheel(localFader, newValue));
+
+    // One 32-bit pitch bend packet per update
+    if (outputs & FaderSurface::umpOutput)
+        surface.addToOutput(UmpEncoding::pitchBend(localFader, newValue));
+
+    const auto sendInterval = juce::Time::getHighResolutionTicksPerSecond() / juce::jmax(1, maxMoveRateHz.load());
+    pending.nextSendTicks = now + sendInterval;
 }
 
-std::vector<juce::MidiMessage> FaderEngine::createFaderMoveMessages(int faderIndex, int value) const
+void FaderEngine::setActiveProfile(const DawProfile *profile)
 {
-    // Split 14-bit value into MSB and LSB (7 bits each)
-    const int msb = (value >> 7) & 0x7F; // Most significant 7 bits
-    const int lsb = value & 0x7F;        // Least significant 7 bits
+    activeProfile.store(profile, std::memory_order_release);
 
-    const std::array<std::pair<uint8_t, uint8_t>, 6> controls{{
-        // Touch sequence
-        {0x0F, static_cast<uint8_t>(faderIndex)}, // Select fader
-        {0x2F, 0x40},                             // Apply touch pressure
+    // Leaving a DAW keeps its key map, keys aren't captured until another DAW is focused
+    if (profile != nullptr)
+        keyMap.setTable(&profile->keyTable);
 
-        // Fader position
-        {static_cast<uint8_t>(faderIndex), static_cast<uint8_t>(msb)},        // Set coarse position (MSB)
-        {static_cast<uint8_t>(0x20 | faderIndex), static_cast<uint8_t>(lsb)}, // Set fine position (LSB)
+    for (auto &surface : surfaces)
+        surface->setForcedProtocol(profile != nullptr ? profile->protocol : ControlProtocol::Unknown);
+}
 
-        // Release sequence
-        {0x0F, static_cast<uint8_t>(faderIndex)}, // Select fader again
-        {0x2F, 0x00}                              // Remove pressure
-    }};
+void FaderEngine::injectMidiInput(int surfaceIndex, const uint8_t *data, int size)
+{
+    if (surfaceIndex < 0 || surfaceIndex >= getNumSurfaces())
+        return;
+
+    juce::MidiMessage message(data, size, juce::Time::getMillisecondCounterHiRes() * 0.001);
+    surfaces[(size_t)surfaceIndex]->handleIncomingMidiMessage(nullptr, message);
+}
+
+void FaderEngine::detachMidiInputs()
+{
+    for (auto &surface : surfaces)
+        surface->detachMidiInputs();
+}
 
-    // Create MIDI messages from our control sequence
-    std::vector<juce::MidiMessage> messages;
-    messages.reserve(controls.size());
+void FaderEngine::sendOutput()
+{
+    for (auto &surface : surfaces)
+        surface->sendOutput();
+}
 
-    for (const auto &[control, value] : controls)
+// SNAPSHOTS
+//==============================================================================
+void FaderEngine::storeSnapshot(int slot)
+{
+    std::array<int, SceneSnapshots::maxFaders> positions{};
+
+    for (int i = 0; i < numFaders; ++i)
+        positions[(size_t)i] = getFaderValue(i);
+
+    snapshots.store(slot, bankOffset, positions.data(), numFaders);
+}
+
+void FaderEngine::startRecall(int slot)
+{
+    const auto snapshot = snapshots.get(slot);
+    if (!snapshot.isStored)
+        return;
+
+    // A new recall replaces one still running, so let go of what that one touched
+    for (int i = 0; i < numFaders; ++i)
     {
-        messages.emplace_back(
-            juce::MidiMessage::controllerEvent(
-                1, // HUI protocol requires channel 1
-                control,
-                value));
+        if (recallTouchedOutputs[(size_t)i] != 0)
+        {
+            addReleaseToOutput(i, recallTouchedOutputs[(size_t)i]);
+            recallTouchedOutputs[(size_t)i] = 0;
+        }
     }
 
-    return messages;
+    numRecallSteps = 0;
+    nextRecallStep = 0;
+    nextRecallTicks = juce::Time::getHighResolutionTicks();
+
+    for (int i = 0; i < numFaders; ++i)
+    {
+        // Positions go back to the tracks they were stored from. Tracks that aren't banked in
+        // are skipped, recalling again once they are on screen moves them
+        const int snapshotIndex = bankOffset + i - snapshot.bankOffset;
+        if (snapshotIndex < 0 || snapshotIndex >= snapshot.numFaders)
+            continue;
+
+        const int value = snapshot.positions[(size_t)snapshotIndex];
+
+        // Faders under a held key stay with the key, faders already in place aren't sent
+        if (heldFaderKeys[(size_t)i] != 0 || value == getFaderValue(i))
+            continue;
+
+        recallSteps[(size_t)numRecallSteps++] = {i, RecallStep::Type::Touch, value};
+        recallSteps[(size_t)numRecallSteps++] = {i, RecallStep::Type::Position, value};
+        recallSteps[(size_t)numRecallSteps++] = {i, RecallStep::Type::Release, value};
+    }
 }
 
-juce::MidiMessage FaderEngine::createPitchWheelMessage(int faderIndex, int value) const
+uint8_t FaderEngine::takeOverRecall(int faderIndex)
 {
-    // Pitch wheel messages use channels 1-8 for faders 1-8
-    const int midiChannel = faderIndex + 1;
-    return juce::MidiMessage::pitchWheel(midiChannel, value);
+    for (int i = nextRecallStep; i < numRecallSteps; ++i)
+        if (recallSteps[(size_t)i].faderIndex == faderIndex)
+            recallSteps[(size_t)i].faderIndex = -1;
+
+    return std::exchange(recallTouchedOutputs[(size_t)faderIndex], (uint8_t)0);
 }
 
-// BANK SWITCHING
+int FaderEngine::advanceRecall()
+{
+    if (nextRecallStep >= numRecallSteps)
+        return -1;
+
+    const auto now = juce::Time::getHighResolutionTicks();
+    if (now < nextRecallTicks)
+        return juce::jmax(1, (int)std::ceil(juce::Time::highResolutionTicksToSeconds(nextRecallTicks - now) * 1000.0));
+
+    const int pacingMs = recallPacingMs.load();
+
+    while (nextRecallStep < numRecallSteps)
+    {
+        const auto &step = recallSteps[(size_t)nextRecallStep++];
+
+        // Taken over by a key press or ramp, doesn't use up a pacing slot
+        if (step.faderIndex < 0)
+            continue;
+
+        auto &surface = getSurface(step.faderIndex);
+        const int localFader = getLocalFader(step.faderIndex);
+        auto &touched = recallTouchedOutputs[(size_t)step.faderIndex];
+
+        switch (step.type)
+        {
+        case RecallStep::Type::Touch:
+            touched = surface.getActiveOutputs();
+            addTouchToOutput(step.faderIndex, touched);
+            break;
+
+        case RecallStep::Type::Position:
+            // The snapshot replaces whatever motion was left over for this fader
+            pendingMoves[(size_t)step.faderIndex] = {};
+            bankFeedbackWaits[(size_t)step.faderIndex].hasPosition = true;
+            bankFeedbackWaits[(size_t)step.faderIndex].deadlineTicks = 0;
+            surface.getFaderState().set(localFader, step.value);
+            addPositionToOutput(step.faderIndex, touched, step.value);
+            break;
+
+        case RecallStep::Type::Release:
+            addReleaseToOutput(step.faderIndex, touched);
+            touched = 0;
+            break;
+        }
+
+        // Paced: one message per interval, live moves still go out in between
+        if (pacingMs > 0)
+            break;
+    }
+
+    if (nextRecallStep >= numRecallSteps)
+        return -1;
+
+    nextRecallTicks = now + juce::Time::getHighResolutionTicksPerSecond() * pacingMs / 1000;
+    return pacingMs;
+}
+
+// RAMPS
 //==============================================================================
-bool FaderEngine::handleBankSwitching(int keyCode, bool isShiftDown)
+void FaderEngine::startRamps(uint32_t faderMask, double targetDb, int durationMs, FaderRamp::Shape shape)
 {
-    switch (keyCode)
+    const auto now = juce::Time::getHighResolutionTicks();
+
+    for (int i = 0; i < numFaders; ++i)
     {
-    case 18: // '1' key
-        if (isShiftDown)
-            nudgeBankLeft8();
-        else
-            nudgeBankLeft();
-        return true;
-    case 19: // '2' key
-        if (isShiftDown)
-            nudgeBankRight8();
-        else
-            nudgeBankRight();
-        return true;
-    default:
-        return false;
+        // Faders under a held key stay with the key
+        if ((faderMask & (1u << i)) == 0 || heldFaderKeys[(size_t)i] != 0)
+            continue;
+
+        auto &surface = getSurface(i);
+
+        // A ramp or recall already moving this fader hands its touch on, so the DAW sees one pass
+        const auto touched = (uint8_t)(takeOverRamp(i) | takeOverRecall(i));
+
+        auto &ramp = ramps[(size_t)i];
+        ramp.touchedOutputs = touched != 0 ? touched : surface.getActiveOutputs();
+
+        if (touched == 0)
+            addTouchToOutput(i, ramp.touchedOutputs);
+
+        ramp.isActive = true;
+        ramp.shape = shape;
+        ramp.startValue = getFaderValue(i);
+        ramp.targetValue = getTaper(surface).toPosition(targetDb);
+        ramp.startTicks = now;
+        ramp.durationTicks = juce::Time::getHighResolutionTicksPerSecond() * durationMs / 1000;
+        ramp.nextPointTicks = now;
+        ++numActiveRamps;
+
+        // Motion left over from a released key would fight the ramp
+        pendingMoves[(size_t)i] = {};
     }
 }
 
-void FaderEngine::nudgeBankLeft()
+uint8_t FaderEngine::takeOverRamp(int faderIndex)
 {
-    if (midiOutput == nullptr)
-        return;
+    auto &ramp = ramps[(size_t)faderIndex];
 
-    // Logic: Send C2 (58) note on/off for single track left
-    midiOutput->sendMessageNow(juce::MidiMessage::noteOn(1, 48, (uint8_t)127));
-    midiOutput->sendMessageNow(juce::MidiMessage::noteOff(1, 48));
+    if (!ramp.isActive)
+        return 0;
 
-    // Pro Tools: Zone select, button press, button release
-    uint8_t zoneSelect[3] = {0xB0, 0x0F, 0x0A};
-    uint8_t buttonPress[3] = {0xB0, 0x2F, 0x40};
-    uint8_t buttonRelease[3] = {0xB0, 0x2F, 0x00};
+    ramp.isActive = false;
+    --numActiveRamps;
+    return std::exchange(ramp.touchedOutputs, (uint8_t)0);
+}
 
-    midiOutput->sendMessageNow(juce::MidiMessage(zoneSelect, 3));
-    midiOutput->sendMessageNow(juce::MidiMessage(buttonPress, 3));
-    midiOutput->sendMessageNow(juce::MidiMessage(buttonRelease, 3));
+void FaderEngine::stopAllRamps()
+{
+    for (int i = 0; i < numFaders && numActiveRamps > 0; ++i)
+        if (const auto outputs = takeOverRamp(i))
+            addReleaseToOutput(i, outputs);
 }
 
-void FaderEngine::nudgeBankRight()
+int FaderEngine::advanceRamps()
 {
-    if (midiOutput == nullptr)
-        return;
+    if (numActiveRamps == 0)
+        return -1;
 
-    // Logic: Send C#2 (49) note on/off for single track right
-    midiOutput->sendMessageNow(juce::MidiMessage::noteOn(1, 49, (uint8_t)127));
-    midiOutput->sendMessageNow(juce::MidiMessage::noteOff(1, 49));
+    const auto now = juce::Time::getHighResolutionTicks();
+    const auto pointInterval = juce::Time::getHighResolutionTicksPerSecond() / rampPointRateHz.load();
+    juce::int64 nextDueTicks = -1;
+
+    for (int i = 0; i < numFaders; ++i)
+    {
+        auto &ramp = ramps[(size_t)i];
+
+        if (!ramp.isActive)
+            continue;
+
+        if (now >= ramp.nextPointTicks)
+        {
+            auto &surface = getSurface(i);
+            auto &faderState = surface.getFaderState();
+            const int localFader = getLocalFader(i);
 
-    // Pro Tools: Zone select, button press, button release
-    uint8_t zoneSelect[3] = {0xB0, 0x0F, 0x0A};
-    uint8_t buttonPress[3] = {0xB0, 0x2F, 0x42};
-    uint8_t buttonRelease[3] = {0xB0, 0x2F, 0x02};
+            // Worked out from the elapsed time, so a late point catches up rather than stretching the ramp
+            const double t = ramp.durationTicks > 0 ? (double)(now - ramp.startTicks) / (double)ramp.durationTicks : 1.0;
+            const int value = FaderRamp::valueAt(getTaper(surface), ramp.shape, ramp.startValue, ramp.targetValue, t);
 
-    midiOutput->sendMessageNow(juce::MidiMessage(zoneSelect, 3));
-    midiOutput->sendMessageNow(juce::MidiMessage(buttonPress, 3));
-    midiOutput->sendMessageNow(juce::MidiMessage(buttonRelease, 3));
+            if (value != faderState.get(localFader))
+            {
+                faderState.set(localFader, value);
+                addPositionToOutput(i, ramp.touchedOutputs, value);
+            }
+
+            if (t >= 1.0)
+            {
+                addReleaseToOutput(i, takeOverRamp(i));
+                continue;
+            }
+
+            // Points stay on the rate's grid, unless the engine fell a whole point behind
+            ramp.nextPointTicks += pointInterval;
+            if (ramp.nextPointTicks <= now)
+                ramp.nextPointTicks = now + pointInterval;
+        }
+
+        if (nextDueTicks < 0 || ramp.nextPointTicks < nextDueTicks)
+            nextDueTicks = ramp.nextPointTicks;
+    }
+
+    if (nextDueTicks < 0)
+        return -1;
+
+    return juce::jmax(1, (int)std::ceil(juce::Time::highResolutionTicksToSeconds(nextDueTicks - now) * 1000.0));
 }
 
-void FaderEngine::nudgeBankLeft8()
+// BANK SWITCHING
+//==============================================================================
+void FaderEngine::nudgeBank(MidiEncoding::BankAction action)
 {
-    if (midiOutput == nullptr)
-        return;
+    // Banking is driven from the main surface, extenders follow it in the DAW
+    auto &surface = *surfaces.front();
 
-    // Logic: Send note 46 for bank left
-    midiOutput->sendMessageNow(juce::MidiMessage::noteOn(1, 46, (uint8_t)127));
-    midiOutput->sendMessageNow(juce::MidiMessage::noteOff(1, 46));
+    // Logic: bank button note on/off, Pro Tools: zone select, button press, button release
+    const auto &bursts = MidiEncoding::getBankBursts(action);
+    const auto outputs = surface.getActiveOutputs();
 
-    // Pro Tools: Zone select (0A), button press, button release
-    uint8_t zoneSelect[3] = {0xB0, 0x0F, 0x0A};
-    uint8_t buttonPress[3] = {0xB0, 0x2F, 0x41}; // Using port 1 for bank left 8
-    uint8_t buttonRelease[3] = {0xB0, 0x2F, 0x01};
+    if (outputs & FaderSurface::mcuOutput)
+        surface.addToOutput(bursts.mcu);
+    if (outputs & FaderSurface::umpOutput)
+        surface.addToOutput(UmpEncoding::fromMidi1(bursts.mcu));
+    if (outputs & FaderSurface::huiOutput)
+        surface.addToOutput(bursts.hui);
+    surface.sendOutput();
 
-    midiOutput->sendMessageNow(juce::MidiMessage(zoneSelect, 3));
-    midiOutput->sendMessageNow(juce::MidiMessage(buttonPress, 3));
-    midiOutput->sendMessageNow(juce::MidiMessage(buttonRelease, 3));
+    moveBankOffset(action);
 }
 
-void FaderEngine::nudgeBankRight8()
+void FaderEngine::moveBankOffset(MidiEncoding::BankAction action)
 {
-    if (midiOutput == nullptr)
+    // The DAW banks by one track, or by every fader across the surfaces
+    int delta = numFaders;
+    switch (action)
+    {
+    case MidiEncoding::BankAction::Left: delta = -1; break;
+    case MidiEncoding::BankAction::Right: delta = 1; break;
+    case MidiEncoding::BankAction::Left8: delta = -numFaders; break;
+    case MidiEncoding::BankAction::Right8:
+    default: break;
+    }
+
+    // Past the first track the DAW doesn't move either
+    const int newOffset = juce::jlimit(0, maxCachedTracks - numFaders, bankOffset + delta);
+    if (newOffset == bankOffset)
         return;
 
-    // Logic: Send note 47 for bank right
-    midiOutput->sendMessageNow(juce::MidiMessage::noteOn(1, 47, (uint8_t)127));
-    midiOutput->sendMessageNow(juce::MidiMessage::noteOff(1, 47));
+    const auto now = juce::Time::getHighResolutionTicks();
+    const auto timeoutTicks = juce::Time::getHighResolutionTicksPerSecond() * bankFeedbackTimeoutMs / 1000;
+
+    // Feedback is already cached, this adds the outgoing tracks' own moves and recalls.
+    // Faders that never got their track's position have nothing to keep
+    cacheBankFeedback();
+
+    for (int i = 0; i < numFaders; ++i)
+        if (bankFeedbackWaits[(size_t)i].hasPosition)
+            bankPositionCache[(size_t)(bankOffset + i)] = (int16_t)getFaderValue(i);
 
-    // Pro Tools: Zone select (0A), button press, button release
-    uint8_t zoneSelect[3] = {0xB0, 0x0F, 0x0A};
-    uint8_t buttonPress[3] = {0xB0, 0x2F, 0x43}; // Using port 3 for bank right 8
-    uint8_t buttonRelease[3] = {0xB0, 0x2F, 0x03};
+    bankOffset = newOffset;
+
+    for (int i = 0; i < numFaders; ++i)
+    {
+        auto &faderState = getSurface(i).getFaderState();
+        const int localFader = getLocalFader(i);
+        const int cached = bankPositionCache[(size_t)(bankOffset + i)];
+        auto &wait = bankFeedbackWaits[(size_t)i];
+
+        // Moves merged for the old track would land on the new one
+        auto &pending = pendingMoves[(size_t)i];
+        pending.delta = 0;
+        pending.tapSteps = 0;
+
+        // A cached position is used straight away, the DAW's feedback corrects it if the track moved since
+        wait.feedbackCount = faderState.getFeedbackCount(localFader);
+        wait.deadlineTicks = cached >= 0 ? 0 : now + timeoutTicks;
+        wait.hasPosition = cached >= 0;
+
+        if (cached >= 0)
+            faderState.set(localFader, cached);
+    }
+}
+
+void FaderEngine::cacheBankFeedback()
+{
+    for (int i = 0; i < numFaders; ++i)
+    {
+        const auto &faderState = getSurface(i).getFaderState();
+        const int localFader = getLocalFader(i);
+        const auto feedbackCount = faderState.getFeedbackCount(localFader);
+        auto &wait = bankFeedbackWaits[(size_t)i];
+
+        if (feedbackCount == wait.feedbackCount)
+            continue;
+
+        // The count is read first, so the position is at least as new as the feedback counted
+        wait.feedbackCount = feedbackCount;
+        wait.deadlineTicks = 0;
+        wait.hasPosition = true;
+        bankPositionCache[(size_t)(bankOffset + i)] = (int16_t)faderState.get(localFader);
+    }
+}
+
+bool FaderEngine::isWaitingForBankFeedback(uint32_t faderMask, juce::int64 now)
+{
+    bool isWaiting = false;
+
+    for (int i = 0; i < numFaders; ++i)
+    {
+        auto &wait = bankFeedbackWaits[(size_t)i];
+
+        if ((faderMask & (1u << i)) == 0 || wait.deadlineTicks == 0)
+            continue;
+
+        // Feedback clears the deadline as it's cached. Past it the DAW isn't going to send any,
+        // and queuePendingMove drops moves for the fader until it does
+        if (now >= wait.deadlineTicks)
+            wait.deadlineTicks = 0;
+        else
+            isWaiting = true;
+    }
 
-    midiOutput->sendMessageNow(juce::MidiMessage(zoneSelect, 3));
-    midiOutput->sendMessageNow(juce::MidiMessage(buttonPress, 3));
-    midiOutput->sendMessageNow(juce::MidiMessage(buttonRelease, 3));
+    return isWaiting;
 }
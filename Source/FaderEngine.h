@@ -2,13 +2,44 @@
 
 #include <JuceHeader.h>
 #include <array>
+#include <vector>
+#include "DawProfiles.h"
+#include "EngineStats.h"
+#include "FaderRamp.h"
+#include "FaderSurface.h"
+#include "FaderTaper.h"
+#include "KeyEventQueue.h"
+#include "KeyMap.h"
+#include "MidiEncoding.h"
+#include "MotionCurve.h"
+#include "SceneSnapshots.h"
+#include "TraceRecorder.h"
+#include "UmpEncoding.h"
 
 /**
  * FaderEngine handles all MIDI communication and fader control logic.
- * It implements the HUI protocol for communicating with DAWs and manages
- * the state of 8 virtual faders.
+ * It implements the HUI and MCU protocols for communicating with DAWs and
+ * manages one or more virtual surfaces of 8 faders each.
+ *
+ * Key events are queued from the global key listener and handled on a
+ * dedicated high-priority engine thread, so key-to-MIDI latency does not
+ * depend on the message thread. Option and Control pick which surface the
+ * fader keys control. A key on a grouped fader moves the whole fader
+ * group together.
+ *
+ * With MIDI 2.0 enabled, surfaces whose host answers MIDI-CI discovery
+ * send MCU fader positions as 32-bit MIDI 2.0 pitch bend packets.
+ *
+ * Snapshot keys store every fader's position with the bank it was on and
+ * recall it onto the same tracks later. A recall
+ * touches, moves and releases each fader one message at a time on the
+ * engine thread, so live key presses still go out between its messages.
+ *
+ * Ramp keys glide faders to a level over a set time. Ramps run on the
+ * engine thread at the ramp point rate, any number of faders at once, and
+ * a key that moves a ramping fader stops its ramp.
  */
-class FaderEngine : public juce::MidiInputCallback
+class FaderEngine : private juce::Thread
 {
 public:
     enum class NudgeSensitivity
@@ -18,48 +49,335 @@ public:
         High
     };
 
-    FaderEngine();
+    static constexpr int maxSurfaces = 4;
+
+    explicit FaderEngine(int numSurfaces = 1, bool useMidi2 = false);
     ~FaderEngine() override;
 
-    void handleIncomingMidiMessage(juce::MidiInput *source, const juce::MidiMessage &message) override;
+    int getNumSurfaces() const { return (int)surfaces.size(); }
 
     // Called by the tray icon menu to change sensitivity
-    NudgeSensitivity getNudgeSensitivity() const { return sensitivity; }
-    void setNudgeSensitivity(NudgeSensitivity newSensitivity) { sensitivity = newSensitivity; }
+    NudgeSensitivity getNudgeSensitivity() const { return sensitivity.load(); }
+    void setNudgeSensitivity(NudgeSensitivity newSensitivity) { sensitivity.store(newSensitivity); }
+
+    // Called by the tray icon menu to change how held keys accelerate
+    MotionCurve::Shape getAccelerationCurve() const { return accelerationCurve.load(); }
+    void setAccelerationCurve(MotionCurve::Shape newCurve) { accelerationCurve.store(newCurve); }
+
+    /** The key layout, shared with the key listener */
+    KeyMap &getKeyMap() { return keyMap; }
+
+    /** Per-DAW profiles, resolved by the key listener when focus changes */
+    DawProfiles &getDawProfiles() { return dawProfiles; }
+
+    /** The focused DAW's profile, or nullptr if no known DAW is focused. Safe to call from any thread */
+    const DawProfile *getActiveProfile() const { return activeProfile.load(std::memory_order_acquire); }
+
+    /** Applies a profile's key map and protocol. Call when focus changes */
+    void setActiveProfile(const DawProfile *profile);
+
+    /** Queues a key event for the engine thread. Safe to call from the key listener's thread.
+        timestampTicks is when the OS captured the key (juce::Time::getHighResolutionTicks()), 0 for now.
+        Returns false if the queue was full and the event was dropped */
+    bool postKeyEvent(int keyCode, bool isKeyDown, int modifiers, bool isRepeat = false, juce::int64 timestampTicks = 0);
+
+    /** Handles a key event. Must be called on the engine thread */
+    void handleGlobalKeycode(int keyCode, bool isKeyDown, int modifiers, bool isRepeat = false);
+
+    /** When enabled, a fader stays touched while its key is held instead of touching per nudge */
+    bool isHoldToTouchEnabled() const { return holdToTouch.load(); }
+    void setHoldToTouchEnabled(bool shouldHoldToTouch) { holdToTouch.store(shouldHoldToTouch); }
+
+    /** Faders that move together, one bit per fader index across all surfaces. Safe to call from any thread */
+    uint32_t getFaderGroup() const { return faderGroup.load(); }
+    void setFaderGroup(uint32_t newGroup) { faderGroup.store(newGroup); }
+
+    /** When disabled, grouped faders move on their own again */
+    bool isGroupEnabled() const { return groupEnabled.load(); }
+    void setGroupEnabled(bool shouldGroup) { groupEnabled.store(shouldGroup); }
+
+    /** Converts between a fader group and its settings form, fader numbers from 1 like "1 2 3 4" */
+    static uint32_t parseFaderGroup(const juce::String &faderNumbers);
+    static juce::String formatFaderGroup(uint32_t group);
+
+    /** A fader's last known position, across all surfaces. Safe to call from any thread */
+    int getFaderValue(int faderIndex) const
+    {
+        return surfaces[(size_t)(faderIndex / FaderState::numFaders)]->getFaderState().get(getLocalFader(faderIndex));
+    }
+
+    /** The protocol detected from the first surface's DAW feedback; Unknown means both are sent */
+    ControlProtocol getDetectedProtocol() const { return surfaces.front()->getDetectedProtocol(); }
+
+    /** Whether surfaces open MIDI 2.0 ports, fixed when the engine is created */
+    bool isMidi2Enabled() const { return midi2Enabled; }
+
+    /** True while the first surface sends MIDI 2.0 packets to a MIDI-CI host. Safe to call from any thread */
+    bool isMidi2Active() const { return surfaces.front()->isUmpActive(); }
+
+    /** Track names the DAW shows on a surface's displays, for the faders its keys control */
+    const ScribbleStrips &getScribbleStrips(int surfaceIndex) const { return surfaces[(size_t)surfaceIndex]->getScribbleStrips(); }
+
+    /** Meter peaks the DAW sends a surface, sampled by the UI */
+    MeterLevels &getMeterLevels(int surfaceIndex) { return surfaces[(size_t)surfaceIndex]->getMeterLevels(); }
+
+    /** Stage latencies and throughput counters for the key and MIDI paths */
+    const EngineStats &getStats() const { return stats; }
 
-    void handleGlobalKeycode(int keyCode, bool isKeyDown, bool isShiftDown);
+    /** Where the stats report is written while recording. Call from the message thread */
+    void setStatsFile(const juce::File &file) { statsFile = file; }
+
+    /** Turns stats recording on or off. Call from the message thread */
+    bool isRecordingStats() const { return stats.isEnabled(); }
+    void setRecordingStats(bool shouldRecord);
+
+    /** Records handled key events and MIDI traffic to a trace file */
+    TraceRecorder &getTraceRecorder() { return traceRecorder; }
+
+    /** Feeds a message to a surface as if the DAW had sent it. Used by trace replay */
+    void injectMidiInput(int surfaceIndex, const uint8_t *data, int size);
+
+    /** Stops every surface's DAW input, so injected messages are the only feedback a surface decodes.
+        Call from the message thread before injecting from another thread */
+    void detachMidiInputs();
+
+    /** Has the engine thread check its held key, touch and bank bookkeeping at the end of its next
+        pass and waits for it. Returns the first inconsistency found, or an empty string. With
+        expectAllReleased, a key or touch still held is one too. Used by the fuzzer */
+    juce::String checkConsistency(bool expectAllReleased);
+
+    /** Upper limit on how often a single fader sends a new position */
+    int getMaxMoveRateHz() const { return maxMoveRateHz.load(); }
+    void setMaxMoveRateHz(int newRateHz) { maxMoveRateHz.store(juce::jlimit(1, 1000, newRateHz)); }
+
+    /** Stored fader snapshots, recalled with the snapshot keys */
+    SceneSnapshots &getSnapshots() { return snapshots; }
+
+    /** Time between a recall's messages, 0 sends the whole recall in one block */
+    int getRecallPacingMs() const { return recallPacingMs.load(); }
+    void setRecallPacingMs(int newPacingMs) { recallPacingMs.store(juce::jlimit(0, 50, newPacingMs)); }
+
+    /** How often a ramping fader sends a new position */
+    int getRampPointRateHz() const { return rampPointRateHz.load(); }
+    void setRampPointRateHz(int newRateHz) { rampPointRateHz.store(juce::jlimit(10, 1000, newRateHz)); }
 
 private:
-    /** Creates MIDI messages for fader movement following HUI protocol */
-    std::vector<juce::MidiMessage> createFaderMoveMessages(int faderIndex, int value) const;
+    /** Engine thread: drains the key event queue and emits MIDI */
+    void run() override;
 
-    /** Creates pitch wheel message for Logic Pro compatibility */
-    juce::MidiMessage createPitchWheelMessage(int faderIndex, int value) const;
+    /** Sends everything queued on every surface */
+    void sendOutput();
 
-    /** Handles bank switching commands */
-    bool handleBankSwitching(int keyCode, bool isShiftDown);
+    // Shared with the surfaces, so declared before them
+    EngineStats stats;
+    juce::File statsFile;
+    std::unique_ptr<StatsFileWriter> statsWriter;
+    TraceRecorder traceRecorder;
 
-    // MIDI setup devices
-    void setupMidiDevices();
-    void closeMidiDevices();
+    // One surface per port pair, 8 faders each. Faders are indexed across all
+    // surfaces, so fader 9 is the first fader of the second surface.
+    std::vector<std::unique_ptr<FaderSurface>> surfaces;
+    int numFaders = 0;
+    const bool midi2Enabled;
 
-    std::unique_ptr<juce::MidiOutput> midiOutput;
-    std::unique_ptr<juce::MidiInput> midiInput;
+    FaderSurface &getSurface(int faderIndex) { return *surfaces[(size_t)(faderIndex / FaderState::numFaders)]; }
+    static int getLocalFader(int faderIndex) { return faderIndex % FaderState::numFaders; }
 
-    // fader values
-    static constexpr int numFaders = 8;
-    std::array<int, numFaders> faderValues{};
+    /** The surface the Option/Control layer picks, or -1 if there is no such surface */
+    int getSurfaceForModifiers(int modifiers) const;
 
     // Fader nudge methods
     void nudgeFader(int faderIndex, int delta);
+    void nudgeFaderTap(int faderIndex, int numSteps, double stepDb);
+
+    /** The focused DAW's taper, or the usual one for the surface's protocol */
+    const FaderTaper &getTaper(const FaderSurface &surface) const;
+
+    /** Sends merged moves for every fader whose rate limit allows it.
+        Returns the milliseconds until the next held-back move is due, or -1 if none */
+    int flushPendingMoves();
+
+    /** Queues the merged move for one fader, ignoring its rate limit */
+    void queuePendingMove(int faderIndex, juce::int64 now);
+
+    /** Moves every fader with a held key by one motion tick.
+        Returns the milliseconds until the next tick, or -1 if no fader key is held */
+    int advanceHeldFaders();
+
+    /** The sensitivity's motion profile, or the coarsest one while shift is held */
+    const MotionCurve::Profile &getMotionProfile(bool isShiftDown) const;
+
+    // Continuous motion for held keys (engine thread only)
+    struct FaderMotion
+    {
+        juce::int64 pressedTicks = 0;
+        bool isCoarse = false;
+        double remainder = 0.0;
+    };
+    std::vector<FaderMotion> faderMotion;
+    int numHeldFaders = 0;
+    juce::int64 lastMotionTicks = 0;
+    std::atomic<MotionCurve::Shape> accelerationCurve{MotionCurve::Shape::Linear};
+
+    // Fader touch tracking for hold-to-touch
+    void pressFaderKey(int faderIndex, uint8_t keyBit, bool isShiftDown);
+    void releaseFaderKey(int faderIndex, uint8_t keyBit);
+    void addTouchToOutput(int faderIndex, uint8_t outputs);
+    void addPositionToOutput(int faderIndex, uint8_t outputs, int value);
+    void addReleaseToOutput(int faderIndex, uint8_t outputs);
+    void releaseAllFaders();
+
+    // Held up/down keys and the protocols each fader is touched on (engine thread only)
+    std::vector<uint8_t> heldFaderKeys;
+    std::vector<uint8_t> touchedOutputs;
+
+    // The faders and key bit each held key went to, so its key up releases the same
+    // faders even if the modifiers, key map or group changed in between (engine thread only)
+    struct HeldKey
+    {
+        uint32_t faderMask = 0;
+        uint8_t keyBit = 0;
+    };
+    std::array<HeldKey, KeyBindings::numKeyCodes> heldKeys{};
+    std::atomic<bool> holdToTouch{true};
+
+    // Fader grouping, a fader mask fits every fader of every surface
+    static_assert(maxSurfaces * FaderState::numFaders <= 32, "Fader masks are 32 bits");
+
+    /** The group a key on this fader moves, or just the fader itself if it isn't grouped */
+    uint32_t getFadersToMove(int faderIndex) const;
+
+    std::atomic<uint32_t> faderGroup{0};
+    std::atomic<bool> groupEnabled{true};
+
+    // Moves waiting for their fader's next send slot (engine thread only)
+    struct PendingMove
+    {
+        int delta = 0;        // Held motion, in 14-bit steps
+        int tapSteps = 0;     // Taps, in steps of tapDb
+        double tapDb = 0.0;
+        juce::int64 nextSendTicks = 0;
+
+        bool hasMove() const { return delta != 0 || tapSteps != 0; }
+    };
+    std::vector<PendingMove> pendingMoves;
+    std::atomic<int> maxMoveRateHz{100};
+
+    // Snapshot methods
+    void storeSnapshot(int slot);
+    void startRecall(int slot);
+
+    /** Stops the recall on one fader and returns the protocols it left touched */
+    uint8_t takeOverRecall(int faderIndex);
+
+    /** Sends the recall's next message, or all of them with no pacing.
+        Returns the milliseconds until the next one is due, or -1 if the recall is done */
+    int advanceRecall();
+
+    // A recall is a touch, position and release per fader, sent in order (engine thread only)
+    struct RecallStep
+    {
+        enum class Type : uint8_t
+        {
+            Touch,
+            Position,
+            Release
+        };
+
+        int faderIndex = -1; // -1 once a key press or ramp took the fader over
+        Type type = Type::Touch;
+        int value = 0;
+    };
+    std::array<RecallStep, 3 * maxSurfaces * FaderState::numFaders> recallSteps{};
+    int numRecallSteps = 0;
+    int nextRecallStep = 0;
+    juce::int64 nextRecallTicks = 0;
+
+    // The protocols each fader was touched on by the recall (engine thread only)
+    std::vector<uint8_t> recallTouchedOutputs;
+
+    SceneSnapshots snapshots;
+    std::atomic<int> recallPacingMs{2};
+
+    // Ramp methods
+    void startRamps(uint32_t faderMask, double targetDb, int durationMs, FaderRamp::Shape shape);
+
+    /** Stops a fader's ramp where it is and returns the protocols it left touched */
+    uint8_t takeOverRamp(int faderIndex);
+
+    /** Stops every ramp and releases its fader */
+    void stopAllRamps();
+
+    /** Sends a point for every ramp that is due.
+        Returns the milliseconds until the next point, or -1 if nothing is ramping */
+    int advanceRamps();
+
+    // One ramp per fader, sized once with the other per-fader state (engine thread only)
+    struct Ramp
+    {
+        bool isActive = false;
+        FaderRamp::Shape shape = FaderRamp::Shape::Linear;
+        int startValue = 0;
+        int targetValue = 0;
+        juce::int64 startTicks = 0;
+        juce::int64 durationTicks = 0;
+        juce::int64 nextPointTicks = 0;
+        uint8_t touchedOutputs = 0;
+    };
+    std::vector<Ramp> ramps;
+    int numActiveRamps = 0;
+    std::atomic<int> rampPointRateHz{100};
+
+    // The fader the last fader key went to, for ramp keys without a fader (engine thread only)
+    int lastFaderIndex = 0;
 
     // Bank methods
-    void nudgeBankLeft();
-    void nudgeBankRight();
-    void nudgeBankLeft8();
-    void nudgeBankRight8();
+    void nudgeBank(MidiEncoding::BankAction action);
+
+    /** Caches the outgoing bank's positions and shows the cached ones for the tracks banked in */
+    void moveBankOffset(MidiEncoding::BankAction action);
+
+    /** Caches every position the DAW sent since the last call under its current track */
+    void cacheBankFeedback();
+
+    /** True while a fader in the mask has no position for its new track and hasn't timed out yet */
+    bool isWaitingForBankFeedback(uint32_t faderMask, juce::int64 now);
+
+    // Positions by track index (bank offset + fader), -1 where no position is known yet.
+    // A flat table rather than a map, so banking never allocates (engine thread only)
+    static constexpr int maxCachedTracks = 1024;
+    std::array<int16_t, maxCachedTracks> bankPositionCache;
+    int bankOffset = 0;
+
+    // Faders showing a track with no cached position hold their moves back until the DAW
+    // sends one, deadline 0 when not waiting. Past the deadline their moves are dropped,
+    // since the only position left is the old track's (engine thread only)
+    struct BankFeedbackWait
+    {
+        uint32_t feedbackCount = 0; // Feedback count last cached
+        juce::int64 deadlineTicks = 0;
+        bool hasPosition = true;
+    };
+    std::vector<BankFeedbackWait> bankFeedbackWaits;
+
+    std::atomic<NudgeSensitivity> sensitivity{NudgeSensitivity::Medium};
+
+    KeyMap keyMap;
+
+    DawProfiles dawProfiles;
+    std::atomic<const DawProfile *> activeProfile{nullptr};
+
+    // Key events from the listener, drained by the engine thread
+    KeyEventQueue keyEvents;
+
+    /** The first inconsistency in the held key, touch and bank state (engine thread only) */
+    juce::String findInconsistency(bool expectAllReleased) const;
 
-    NudgeSensitivity sensitivity = NudgeSensitivity::Medium;
+    // A check asked for by checkConsistency: 0 none, 1 check, 2 check with every key released.
+    // The engine thread writes the result before setting the done flag
+    std::atomic<int> consistencyRequest{0};
+    std::atomic<bool> isConsistencyChecked{false};
+    juce::String consistencyProblem;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FaderEngine)
 };
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include "FaderTaper.h"
+
+/**
+ * Shapes for timed fader ramps, e.g. fading a bus out over 4 seconds.
+ * A ramp's positions are worked out per point from the elapsed time, so a
+ * late point catches up instead of stretching the ramp.
+ */
+namespace FaderRamp
+{
+    enum class Shape : uint8_t
+    {
+        Linear,   // Even steps of fader travel
+        LogTaper, // Even steps in dB on the DAW's taper, the usual choice for fades
+        SCurve    // Eases in and out of the move
+    };
+
+    /** How far along the shape is, 0-1, after a fraction t of the ramp's time */
+    inline double amountAt(Shape shape, double t)
+    {
+        t = std::clamp(t, 0.0, 1.0);
+        return shape == Shape::SCurve ? t * t * (3.0 - 2.0 * t) : t;
+    }
+
+    /** The fader position a fraction t of the way through a ramp */
+    inline int valueAt(const FaderTaper &taper, Shape shape, int startValue, int targetValue, double t)
+    {
+        const double amount = amountAt(shape, t);
+
+        if (amount >= 1.0)
+            return targetValue;
+
+        // Table lookups both ways, no log/pow per point
+        if (shape == Shape::LogTaper)
+        {
+            const double startDb = taper.toDb(startValue);
+            return taper.toPosition(startDb + (taper.toDb(targetValue) - startDb) * amount);
+        }
+
+        return startValue + (int)((targetValue - startValue) * amount + (targetValue > startValue ? 0.5 : -0.5));
+    }
+}
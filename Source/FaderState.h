@@ -0,0 +1,72 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/**
+ * Fader positions shared between the MIDI input thread (DAW feedback) and
+ * the engine thread (key moves). Each position is one atomic 14-bit value,
+ * so a reader never sees half of a HUI MSB/LSB update.
+ *
+ * The feedback setters have a single writer: the surface's MIDI input
+ * thread. JUCE delivers one port's input on one thread, so the HUI MSB
+ * held back for its LSB is a plain int. `--stress-fader-state` races that writer against a reader.
+ */
+class FaderState
+{
+public:
+    static constexpr int numFaders = 8;
+    static constexpr int maxValue = 16383;
+
+    static_assert(std::atomic<int>::is_always_lock_free, "Fader positions must be lock-free");
+
+    int get(int faderIndex) const
+    {
+        return values[(size_t)faderIndex].load(std::memory_order_acquire);
+    }
+
+    void set(int faderIndex, int value)
+    {
+        values[(size_t)faderIndex].store(juce::jlimit(0, maxValue, value), std::memory_order_release);
+    }
+
+    /** A position the DAW sent, counted so the engine can tell fresh feedback arrived (MIDI input thread only) */
+    void setFromFeedback(int faderIndex, int value)
+    {
+        set(faderIndex, value);
+        feedbackCounts[(size_t)faderIndex].fetch_add(1, std::memory_order_release);
+    }
+
+    /** Goes up with every position the DAW sends for this fader. Safe to call from any thread */
+    uint32_t getFeedbackCount(int faderIndex) const
+    {
+        return feedbackCounts[(size_t)faderIndex].load(std::memory_order_acquire);
+    }
+
+    /** HUI coarse position. Held back until its LSB arrives (MIDI input thread only) */
+    void setHuiMsb(int faderIndex, int msb)
+    {
+        pendingMsbs[(size_t)faderIndex] = msb & 0x7F;
+    }
+
+    /** HUI fine position. Publishes the full value with the pending MSB (MIDI input thread only) */
+    void setHuiLsb(int faderIndex, int lsb)
+    {
+        auto &pendingMsb = pendingMsbs[(size_t)faderIndex];
+
+        // An LSB on its own only changes the fine half of the current position
+        const int msb = pendingMsb >= 0 ? pendingMsb : get(faderIndex) >> 7;
+        pendingMsb = -1;
+
+        setFromFeedback(faderIndex, (msb << 7) | (lsb & 0x7F));
+    }
+
+private:
+    std::array<std::atomic<int>, numFaders> values{};
+    std::array<std::atomic<uint32_t>, numFaders> feedbackCounts{};
+
+    // MSBs waiting for their LSB, -1 when none. Not atomic: only the MIDI input thread touches them,
+    // calling setHuiMsb/setHuiLsb from a second thread would pair one thread's MSB with another's LSB
+    std::array<int, numFaders> pendingMsbs{-1, -1, -1, -1, -1, -1, -1, -1};
+};
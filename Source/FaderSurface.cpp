@@ -0,0 +1,276 @@
+#include "FaderSurface.h"
+
+namespace
+{
+    // The first surface keeps the original port names so existing DAW setups still find it
+    juce::String getPortName(int surfaceIndex, const juce::String &direction)
+    {
+        if (surfaceIndex == 0)
+            return "Fader Keys MIDI " + direction;
+
+        return "Fader Keys " + juce::String(surfaceIndex + 1) + " MIDI " + direction;
+    }
+}
+
+// CONSTRUCTOR / DESTRUCTOR
+//==============================================================================
+FaderSurface::FaderSurface(int surfaceIndex, EngineStats &statsToUpdate, TraceRecorder &recorderToUse, bool useMidi2)
+    : index(surfaceIndex),
+      stats(statsToUpdate),
+      traceRecorder(recorderToUse),
+      midiDecoder(*this)
+{
+    setupMidiDevices(surfaceIndex);
+
+    if (useMidi2)
+        setupUmpDevices(surfaceIndex);
+}
+
+FaderSurface::~FaderSurface()
+{
+    closeMidiDevices();
+}
+
+// MIDI DEVICE SETUP / TEARDOWN
+//==============================================================================
+void FaderSurface::setupMidiDevices(int surfaceIndex)
+{
+    midiOutput = MidiBlockOutput::create(getPortName(surfaceIndex, "Output"));
+    if (midiOutput == nullptr)
+        DBG("Failed to create virtual MIDI output device for surface " << surfaceIndex + 1);
+
+    midiInput = juce::MidiInput::createNewDevice(getPortName(surfaceIndex, "Input"), this);
+    if (midiInput == nullptr)
+    {
+        DBG("Failed to create virtual MIDI input device for surface " << surfaceIndex + 1);
+    }
+    else
+    {
+        midiInput->start();
+    }
+}
+
+void FaderSurface::setupUmpDevices(int surfaceIndex)
+{
+    // Where there are no MIDI 2.0 ports the surface just stays on MIDI 1.0
+    umpPort = UmpPort::create(getPortName(surfaceIndex, "2.0 Output"), getPortName(surfaceIndex, "2.0 Input"), *this);
+    if (umpPort == nullptr)
+        return;
+
+    // The port can deliver as soon as it's open, so the session is only published once it's built
+    ciSessionOwner = std::make_unique<MidiCiSession>(*umpPort);
+    ciSession.store(ciSessionOwner.get(), std::memory_order_release);
+}
+
+void FaderSurface::closeMidiDevices()
+{
+    // The MIDI 2.0 port goes first so no input callback reaches the session while it is torn down
+    ciSession.store(nullptr, std::memory_order_release);
+    umpPort.reset();
+    ciSessionOwner.reset();
+
+    if (midiInput != nullptr)
+    {
+        midiInput->stop();
+        midiInput.reset();
+    }
+    midiOutput.reset();
+}
+
+void FaderSurface::detachMidiInputs()
+{
+    // The decoder's HUI MSB state has a single writer, which is whoever injects from here on.
+    // The MIDI 2.0 port stays open, the engine thread sends on it and its input never decodes HUI
+    if (midiInput != nullptr)
+        midiInput->stop();
+}
+
+// INCOMING MIDI MESSAGE HANDLING
+//==============================================================================
+void FaderSurface::handleIncomingMidiMessage(juce::MidiInput *,
+                                             const juce::MidiMessage &message)
+{
+    traceRecorder.recordMidi(TraceFile::RecordType::MidiIn, index, message.getRawData(), message.getRawDataSize());
+
+    if (!stats.isEnabled())
+    {
+        midiDecoder.feed(message.getRawData(), message.getRawDataSize());
+        return;
+    }
+
+    // JUCE stamps incoming messages with the millisecond counter, in seconds
+    const auto callbackTicks = juce::Time::getHighResolutionTicks();
+    const auto deliveryMicros = (juce::Time::getMillisecondCounterHiRes() * 0.001 - message.getTimeStamp()) * 1.0e6;
+
+    midiDecoder.feed(message.getRawData(), message.getRawDataSize());
+
+    stats.record(EngineStats::Stage::MidiInDecode, juce::Time::getHighResolutionTicks() - callbackTicks);
+    stats.recordMicros(EngineStats::Stage::MidiInDelivery, juce::jmax(0.0, deliveryMicros));
+    stats.add(EngineStats::Counter::MidiMessagesIn);
+    stats.add(EngineStats::Counter::MidiBytesIn, message.getRawDataSize());
+}
+
+void FaderSurface::huiPing()
+{
+    // An MCU host sends the same bytes for REC ARM 1's LED, and the reply would press REC ARM 1
+    if (getDetectedProtocol() == ControlProtocol::Mcu)
+        return;
+
+    protocolDetector.addEvidence(ControlProtocol::Hui);
+
+    traceRecorder.recordMidi(TraceFile::RecordType::MidiOut, index,
+                             MidiEncoding::huiPingReply.data(), (int)MidiEncoding::huiPingReply.size());
+
+    if (midiOutput != nullptr)
+        midiOutput->send(MidiEncoding::huiPingReply.data(), (int)MidiEncoding::huiPingReply.size());
+}
+
+void FaderSurface::huiFaderByte(int faderIndex, bool isMsb, int value)
+{
+    // HUI sends the MSB then the LSB as separate CCs, the position is published once both are in
+    if (isMsb)
+        faderState.setHuiMsb(faderIndex, value);
+    else
+        faderState.setHuiLsb(faderIndex, value);
+}
+
+void FaderSurface::pitchWheel(int channelIndex, int value)
+{
+    // Logic pitch wheel messages, channels 1-8 for faders 1-8
+    if (channelIndex < FaderState::numFaders)
+        faderState.setFromFeedback(channelIndex, value);
+}
+
+void FaderSurface::meterLevel(int channelIndex, int level)
+{
+    // Meters stream for every channel while the DAW plays, so this is a single atomic update
+    meterLevels.setLevel(channelIndex, level);
+}
+
+void FaderSurface::sysEx(const uint8_t *data, int size)
+{
+    // Display updates stream in all the time, the names are updated in place
+    scribbleStrips.handleSysEx(data, size);
+}
+
+void FaderSurface::protocolEvidence(ControlProtocol protocol)
+{
+    protocolDetector.addEvidence(protocol);
+}
+
+void FaderSurface::handleIncomingUmp(const uint32_t *words, int numWords)
+{
+    // Fader positions only touch the atomic fader state, so this thread never
+    // shares the decoder or protocol detector with the MIDI 1.0 input thread
+    for (int i = 0; i < numWords;)
+    {
+        const auto *packet = words + i;
+        const int packetWords = UmpEncoding::getNumWords(packet[0]);
+        i += packetWords;
+
+        if (i > numWords)
+            break;
+
+        if (stats.isEnabled())
+        {
+            stats.add(EngineStats::Counter::MidiMessagesIn);
+            stats.add(EngineStats::Counter::MidiBytesIn, packetWords * 4);
+        }
+
+        const auto type = UmpEncoding::getType(packet[0]);
+        const auto channelIndex = UmpEncoding::getChannel(packet[0]);
+        const bool isPitchBend = UmpEncoding::getStatus(packet[0]) == MidiEncoding::pitchWheelStatus;
+
+        if (type == UmpEncoding::midi2ChannelVoiceType && isPitchBend)
+            pitchWheel(channelIndex, UmpEncoding::scale32To14(packet[1]));
+        else if (type == UmpEncoding::midi1ChannelVoiceType && isPitchBend)
+            pitchWheel(channelIndex, (int)((packet[0] >> 8) & 0x7F) | (int)(packet[0] & 0x7F) << 7);
+        else if (type == UmpEncoding::sysex7Type)
+        {
+            if (auto *session = ciSession.load(std::memory_order_acquire))
+                session->handleSysex7Packet(packet);
+        }
+    }
+}
+
+// OUTPUT
+//==============================================================================
+ControlProtocol FaderSurface::getDetectedProtocol() const
+{
+    const auto protocol = protocolDetector.getProtocol();
+
+    // Only MCU hosts answer MIDI-CI discovery on the MIDI 2.0 port
+    if (protocol == ControlProtocol::Unknown && isUmpActive())
+        return ControlProtocol::Mcu;
+
+    return protocol;
+}
+
+uint8_t FaderSurface::getActiveOutputs() const
+{
+    switch (getDetectedProtocol())
+    {
+    case ControlProtocol::Hui:
+        return huiOutput;
+    case ControlProtocol::Mcu:
+        return isUmpActive() ? umpOutput : mcuOutput;
+    case ControlProtocol::Unknown:
+    default:
+        return huiOutput | mcuOutput;
+    }
+}
+
+void FaderSurface::sendOutput()
+{
+    sendMidiOutput();
+    sendUmpOutput();
+}
+
+void FaderSurface::sendMidiOutput()
+{
+    if (traceRecorder.isRecording())
+        for (int i = 0; i < numBytesQueued; i += (int)MidiEncoding::messageSize)
+            traceRecorder.recordMidi(TraceFile::RecordType::MidiOut, index, outputBytes.data() + i, (int)MidiEncoding::messageSize);
+
+    if (midiOutput != nullptr && numBytesQueued > 0)
+    {
+        if (stats.isEnabled())
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            midiOutput->send(outputBytes.data(), numBytesQueued);
+
+            stats.record(EngineStats::Stage::MidiSend, juce::Time::getHighResolutionTicks() - start);
+            stats.add(EngineStats::Counter::MidiMessagesOut, numBytesQueued / MidiEncoding::messageSize);
+            stats.add(EngineStats::Counter::MidiBytesOut, numBytesQueued);
+        }
+        else
+        {
+            midiOutput->send(outputBytes.data(), numBytesQueued);
+        }
+    }
+
+    numBytesQueued = 0;
+}
+
+void FaderSurface::sendUmpOutput()
+{
+    if (umpPort != nullptr && numUmpWordsQueued > 0)
+    {
+        if (stats.isEnabled())
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            umpPort->send(umpOutputBuffer.data(), numUmpWordsQueued);
+
+            stats.record(EngineStats::Stage::MidiSend, juce::Time::getHighResolutionTicks() - start);
+            stats.add(EngineStats::Counter::MidiMessagesOut, numUmpPacketsQueued);
+            stats.add(EngineStats::Counter::MidiBytesOut, numUmpWordsQueued * 4);
+        }
+        else
+        {
+            umpPort->send(umpOutputBuffer.data(), numUmpWordsQueued);
+        }
+    }
+
+    numUmpWordsQueued = 0;
+    numUmpPacketsQueued = 0;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "EngineStats.h"
+#include "FaderState.h"
+#include "MeterLevels.h"
+#include "MidiBlockOutput.h"
+#include "MidiCiSession.h"
+#include "MidiDecoder.h"
+#include "MidiEncoding.h"
+#include "ProtocolDetector.h"
+#include "ScribbleStrips.h"
+#include "TraceRecorder.h"
+#include "UmpEncoding.h"
+#include "UmpPort.h"
+
+/**
+ * One virtual control surface: a MIDI port pair the DAW sees as a HUI unit
+ * or an MCU (extender), with its own feedback decoder, protocol detection,
+ * fader state and output buffer. Surfaces share nothing, so traffic on one
+ * never waits on another.
+ *
+ * With MIDI 2.0 enabled a surface also opens a MIDI 2.0 port pair. Once a
+ * host answers MIDI-CI discovery there, MCU messages go out on it as
+ * Universal MIDI Packets instead of through the MIDI 1.0 encoders.
+ *
+ * Track names from the DAW's display sysex and meter peaks are kept per
+ * channel for the UI.
+ */
+class FaderSurface : public juce::MidiInputCallback,
+                     private MidiDecoder::Handler,
+                     private UmpPort::Callback
+{
+public:
+    // Which protocol encoders a message goes through
+    static constexpr uint8_t huiOutput = 0x01;
+    static constexpr uint8_t mcuOutput = 0x02;
+    static constexpr uint8_t umpOutput = 0x04; // MCU as MIDI 2.0 packets
+
+    FaderSurface(int surfaceIndex, EngineStats &statsToUpdate, TraceRecorder &recorderToUse, bool useMidi2 = false);
+    ~FaderSurface() override;
+
+    void handleIncomingMidiMessage(juce::MidiInput *source, const juce::MidiMessage &message) override;
+
+    FaderState &getFaderState() { return faderState; }
+
+    /** Track names from the DAW's displays */
+    const ScribbleStrips &getScribbleStrips() const { return scribbleStrips; }
+
+    /** Meter peaks from the DAW, for the UI to sample */
+    MeterLevels &getMeterLevels() { return meterLevels; }
+
+    /** The protocol detected from DAW feedback; Unknown means both are sent */
+    ControlProtocol getDetectedProtocol() const;
+
+    /** True while a MIDI-CI host is connected on the MIDI 2.0 port. Safe to call from any thread */
+    bool isUmpActive() const
+    {
+        const auto *session = ciSession.load(std::memory_order_acquire);
+        return session != nullptr && session->isPeerConnected();
+    }
+
+    /** Sends only this protocol, or goes back to detecting it with Unknown */
+    void setForcedProtocol(ControlProtocol protocol) { protocolDetector.setForcedProtocol(protocol); }
+
+    /** Which protocol encoders to send through, from the detected protocol */
+    uint8_t getActiveOutputs() const;
+
+    /** Queues a burst in the preallocated output buffer (engine thread only) */
+    template <size_t Size>
+    void addToOutput(const std::array<uint8_t, Size> &burst)
+    {
+        static_assert(Size % MidiEncoding::messageSize == 0, "Bursts hold whole 3-byte messages");
+        static_assert((int)Size <= outputBufferBytes, "Bursts must fit the output buffer");
+
+        if (numBytesQueued + (int)Size > outputBufferBytes)
+            sendMidiOutput();
+
+        std::copy(burst.begin(), burst.end(), outputBytes.begin() + numBytesQueued);
+        numBytesQueued += (int)Size;
+    }
+
+    /** Queues whole MIDI 2.0 packets for the MIDI 2.0 port (engine thread only) */
+    template <size_t NumWords>
+    void addToOutput(const UmpEncoding::Words<NumWords> &packets)
+    {
+        static_assert(NumWords <= umpBufferWords, "Packets must fit the output buffer");
+
+        if (numUmpWordsQueued + (int)NumWords > umpBufferWords)
+            sendUmpOutput();
+
+        for (size_t i = 0; i < NumWords; i += (size_t)UmpEncoding::getNumWords(packets[i]))
+            ++numUmpPacketsQueued;
+
+        std::copy(packets.begin(), packets.end(), umpOutputBuffer.begin() + numUmpWordsQueued);
+        numUmpWordsQueued += (int)NumWords;
+    }
+
+    /** Sends everything queued by addToOutput, the MIDI 1.0 messages as one packet
+        where the platform allows it (engine thread only) */
+    void sendOutput();
+
+    /** Stops the DAW's MIDI 1.0 input, leaving the outputs open, so messages passed to
+        handleIncomingMidiMessage by hand are the only MIDI 1.0 feedback (message thread) */
+    void detachMidiInputs();
+
+private:
+    // Decoded DAW feedback (MIDI input thread)
+    void huiPing() override;
+    void huiFaderByte(int faderIndex, bool isMsb, int value) override;
+    void pitchWheel(int channelIndex, int value) override;
+    void meterLevel(int channelIndex, int level) override;
+    void sysEx(const uint8_t *data, int size) override;
+    void protocolEvidence(ControlProtocol protocol) override;
+
+    // MIDI 2.0 feedback and MIDI-CI (MIDI 2.0 input thread)
+    void handleIncomingUmp(const uint32_t *words, int numWords) override;
+
+    /** Sends the queued MIDI 1.0 messages as one block (engine thread only) */
+    void sendMidiOutput();
+
+    /** Sends the queued MIDI 2.0 packets (engine thread only) */
+    void sendUmpOutput();
+
+    // MIDI setup devices
+    void setupMidiDevices(int surfaceIndex);
+    void setupUmpDevices(int surfaceIndex);
+    void closeMidiDevices();
+
+    std::unique_ptr<MidiBlockOutput> midiOutput;
+    std::unique_ptr<juce::MidiInput> midiInput;
+
+    // Outgoing messages for the key path back to back, sized for the largest key-path send
+    // (HUI move + pitch wheel for every fader) so queueing never allocates
+    static constexpr int outputBufferBytes = 1024;
+    std::array<uint8_t, outputBufferBytes> outputBytes{};
+    int numBytesQueued = 0;
+
+    // MIDI 2.0 port and its discovery, only when MIDI 2.0 is enabled and the platform has the ports
+    std::unique_ptr<UmpPort> umpPort;
+    std::unique_ptr<MidiCiSession> ciSessionOwner;
+
+    // The port's input thread and the engine thread read the session through this. It is
+    // published once the session is fully built, and may still be null after the port opens
+    std::atomic<MidiCiSession *> ciSession{nullptr};
+
+    // Outgoing MIDI 2.0 packets, sent with the MIDI 1.0 block
+    static constexpr int umpBufferWords = 256;
+    std::array<uint32_t, umpBufferWords> umpOutputBuffer{};
+    int numUmpWordsQueued = 0;
+    int numUmpPacketsQueued = 0;
+
+    const int index;
+    EngineStats &stats;
+    TraceRecorder &traceRecorder;
+
+    MidiDecoder midiDecoder;
+    ProtocolDetector protocolDetector;
+    FaderState faderState;
+    ScribbleStrips scribbleStrips;
+    MeterLevels meterLevels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FaderSurface)
+};
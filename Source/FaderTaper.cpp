@@ -0,0 +1,154 @@
+#include "FaderTaper.h"
+
+namespace
+{
+    // Tolerance when deciding which grid line a position sits on, as a fraction of a step.
+    // 14-bit positions can't hit every dB exactly, so a nudged fader lands slightly off grid
+    constexpr double gridTolerance = 0.1;
+
+    // How close a sampled point must round-trip, in dB and in 14-bit steps
+    constexpr double validationDbTolerance = 0.05;
+    constexpr int validationPositionTolerance = 2;
+}
+
+// CONSTRUCTION
+//==============================================================================
+FaderTaper::FaderTaper(std::vector<Point> sampledPoints)
+    : points(std::move(sampledPoints))
+{
+    jassert(points.size() >= 2 && points.front().position == 0.0 && points.back().position == 1.0);
+
+    positionToDb.resize((size_t)FaderState::maxValue + 1);
+    for (int value = 0; value <= FaderState::maxValue; ++value)
+        positionToDb[(size_t)value] = (float)interpolateDb((double)value / FaderState::maxValue);
+
+    const auto numDbSteps = (size_t)((points.back().db - floorDb) * stepsPerDb) + 1;
+    dbToPosition.resize(numDbSteps);
+    for (size_t i = 0; i < numDbSteps; ++i)
+    {
+        const double position = interpolatePosition(floorDb + (double)i / stepsPerDb);
+        dbToPosition[i] = (uint16_t)juce::roundToInt(position * FaderState::maxValue);
+    }
+
+    jassert(checkTables());
+}
+
+double FaderTaper::interpolateDb(double position) const
+{
+    for (size_t i = 1; i < points.size(); ++i)
+    {
+        const auto &low = points[i - 1];
+        const auto &high = points[i];
+
+        if (position <= high.position)
+            return low.db + (high.db - low.db) * (position - low.position) / (high.position - low.position);
+    }
+
+    return points.back().db;
+}
+
+double FaderTaper::interpolatePosition(double db) const
+{
+    for (size_t i = 1; i < points.size(); ++i)
+    {
+        const auto &low = points[i - 1];
+        const auto &high = points[i];
+
+        if (db <= high.db)
+            return low.position + (high.position - low.position) * (db - low.db) / (high.db - low.db);
+    }
+
+    return 1.0;
+}
+
+// NUDGING
+//==============================================================================
+int FaderTaper::nudge(int value, double stepDb, int numSteps) const
+{
+    if (numSteps == 0)
+        return value;
+
+    // Grid line at or just past the current gain in the direction of travel, then whole steps from there
+    const double gridPosition = toDb(value) / stepDb;
+    const double firstStep = numSteps > 0 ? std::floor(gridPosition + gridTolerance) + 1.0
+                                          : std::ceil(gridPosition - gridTolerance) - 1.0;
+    const double targetDb = (firstStep + (numSteps > 0 ? numSteps - 1 : numSteps + 1)) * stepDb;
+
+    const int target = toPosition(targetDb);
+
+    if (numSteps > 0)
+        return juce::jmin(FaderState::maxValue, juce::jmax(target, value + 1));
+
+    return juce::jmax(0, juce::jmin(target, value - 1));
+}
+
+// VALIDATION
+//==============================================================================
+bool FaderTaper::checkTables() const
+{
+    for (const auto &point : points)
+    {
+        // Below the floor every gain maps to the bottom of the fader
+        if (point.db <= floorDb)
+            continue;
+
+        const int position = juce::roundToInt(point.position * FaderState::maxValue);
+
+        if (std::abs(toDb(position) - point.db) > validationDbTolerance
+            || std::abs(toPosition(point.db) - position) > validationPositionTolerance)
+        {
+            DBG("Fader taper point " << point.position << " / " << point.db << "dB doesn't round-trip");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool FaderTaper::validate(const std::vector<Point> &measured, double toleranceDb) const
+{
+    for (const auto &sample : measured)
+    {
+        const auto value = juce::roundToInt(juce::jlimit(0.0, 1.0, sample.position) * FaderState::maxValue);
+        const double expectedDb = juce::jmax(floorDb, sample.db);
+
+        if (std::abs(toDb(value) - expectedDb) > toleranceDb)
+        {
+            DBG("Fader taper gives " << toDb(value) << "dB at " << sample.position << ", the DAW shows " << sample.db << "dB");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// BUILT-IN TAPERS
+//==============================================================================
+const FaderTaper &FaderTaper::getProTools()
+{
+    // +12 dB at the top, unity about three quarters of the way up
+    static const FaderTaper taper({{0.0, floorDb},
+                                   {0.05, -60.0},
+                                   {0.15, -40.0},
+                                   {0.30, -24.0},
+                                   {0.50, -12.0},
+                                   {0.62, -6.0},
+                                   {0.74, 0.0},
+                                   {0.87, 6.0},
+                                   {1.0, 12.0}});
+    return taper;
+}
+
+const FaderTaper &FaderTaper::getMackie()
+{
+    // +6 dB at the top, the law Logic and most MCU hosts use
+    static const FaderTaper taper({{0.0, floorDb},
+                                   {0.05, -72.0},
+                                   {0.15, -48.0},
+                                   {0.30, -30.0},
+                                   {0.50, -15.0},
+                                   {0.64, -7.5},
+                                   {0.77, 0.0},
+                                   {1.0, 6.0}});
+    return taper;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "FaderState.h"
+
+/**
+ * A DAW's fader law as lookup tables between 14-bit fader positions and dB.
+ * The tables are built once from sampled taper points (linear in dB between
+ * points), so a nudge is two table lookups with no log/pow on the key path.
+ */
+class FaderTaper
+{
+public:
+    /** One sampled point on the fader: position 0-1 and its gain in dB */
+    struct Point
+    {
+        double position;
+        double db;
+    };
+
+    // Gain at the bottom of the fader, treated as -inf
+    static constexpr double floorDb = -100.0;
+
+    /** Points must rise in both position and dB, from position 0 to 1 */
+    explicit FaderTaper(std::vector<Point> sampledPoints);
+
+    double toDb(int value) const
+    {
+        return positionToDb[(size_t)juce::jlimit(0, FaderState::maxValue, value)];
+    }
+
+    int toPosition(double db) const
+    {
+        const auto index = (int)((db - floorDb) * stepsPerDb + 0.5);
+        return dbToPosition[(size_t)juce::jlimit(0, (int)dbToPosition.size() - 1, index)];
+    }
+
+    /**
+     * Moves a position by numSteps steps of stepDb (negative to go down), landing on
+     * the stepDb grid: from -3.3 dB, one 1 dB step up lands on -3 dB, two on -2 dB.
+     * Always moves at least one 14-bit step, so the flat ends of the table don't stall.
+     */
+    int nudge(int value, double stepDb, int numSteps) const;
+
+    /** Checks every point the tables were built from round-trips through them.
+        Catches a bad build, but says nothing about whether the points match the DAW */
+    bool checkTables() const;
+
+    /**
+     * Checks the taper against gains read off the DAW itself, e.g. its dB readout
+     * with the fader at a few known positions. Samples at or below floorDb count
+     * as the bottom of the fader. Returns false if any is off by more than toleranceDb
+     */
+    bool validate(const std::vector<Point> &measured, double toleranceDb) const;
+
+    const std::vector<Point> &getPoints() const { return points; }
+
+    // Built-in tapers. The top of each is the DAW's fader range (+12 dB in Pro Tools, +6 dB in Logic),
+    // the points in between approximate its fader scale and haven't been measured. Taps keep fixed
+    // 14-bit steps on them; a profile that checks one with "taperSamples" or gives measured
+    // points instead gets exact dB taps
+    static const FaderTaper &getProTools();
+    static const FaderTaper &getMackie();
+
+private:
+    // dB -> position resolution
+    static constexpr double stepsPerDb = 100.0;
+
+    double interpolateDb(double position) const;
+    double interpolatePosition(double db) const;
+
+    std::vector<Point> points;
+    std::vector<float> positionToDb;
+    std::vector<uint16_t> dbToPosition;
+
+    JUCE_LEAK_DETECTOR(FaderTaper)
+};
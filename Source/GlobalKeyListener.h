@@ -12,6 +12,7 @@
 
 class FaderEngine;
 
-// Start/stop global key listener
+// Start/stop global key listener. Each platform provides its own key source:
+// a CGEventTap on macOS (GlobalKeyListener.mm), evdev + uinput on Linux (GlobalKeyListenerLinux.cpp)
 void startGlobalKeyListener(FaderEngine *engine);
 void stopGlobalKeyListener();
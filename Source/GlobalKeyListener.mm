@@ -13,6 +13,7 @@
 #include "TrayIconMac.h"
 
 #import <Cocoa/Cocoa.h>
+#include <mach/mach_time.h>
 
 @interface ScopedObserver : NSObject
 {
@@ -26,7 +27,7 @@
 - (instancetype)initWithObserver:(id)obs {
     self = [super init];
     if (self) {
-        observer = obs;
+        observer = [obs retain];
     }
     return self;
 }
@@ -34,6 +35,7 @@
 - (void)dealloc {
     if (observer) {
         [[NSWorkspace sharedWorkspace].notificationCenter removeObserver:observer];
+        [observer release];
     }
     [super dealloc];
 }
@@ -48,7 +50,8 @@ namespace
     class FrontmostAppObserver
     {
     public:
-        FrontmostAppObserver()
+        explicit FrontmostAppObserver(FaderEngine* engineToUpdate)
+            : engine(engineToUpdate)
         {
             id obs = [[NSWorkspace sharedWorkspace].notificationCenter
                 addObserverForName:NSWorkspaceDidActivateApplicationNotification
@@ -62,37 +65,42 @@ namespace
             updateCachedState();
         }
 
-        ~FrontmostAppObserver() = default; // The ScopedObserver will clean up automatically
+        ~FrontmostAppObserver()
+        {
+            // Releasing the ScopedObserver removes the observer, so its block (which uses the
+            // engine) can't run once stopGlobalKeyListener() has let go of it
+            [scopedObserver release];
+            scopedObserver = nil;
+        }
 
-        bool isDawFocused() const { return cachedIsDawFocused; }
+        /** Safe to call from the event tap thread */
+        bool isDawFocused() const
+        {
+            const auto* profile = cachedProfile.load(std::memory_order_acquire);
+            return profile != nullptr && profile->enabled;
+        }
 
     private:
         void updateCachedState()
         {
             @autoreleasepool {
                 NSRunningApplication* frontmostApp = [[NSWorkspace sharedWorkspace] frontmostApplication];
-                if (frontmostApp == nil || frontmostApp.bundleIdentifier == nil)
+
+                // Matched once per focus change, the event tap only checks the cached profile
+                const DawProfile* profile = nullptr;
+                if (frontmostApp != nil && frontmostApp.bundleIdentifier != nil)
+                    profile = engine->getDawProfiles().resolve(juce::String([frontmostApp.bundleIdentifier UTF8String]));
+
+                if (profile != cachedProfile.load(std::memory_order_relaxed))
                 {
-                    cachedIsDawFocused = false;
-                    return;
+                    engine->setActiveProfile(profile);
+                    cachedProfile.store(profile, std::memory_order_release);
                 }
-
-                static const std::unordered_set<std::string> supportedDawBundleIDs {
-                    "com.avid.ProTools",    // Pro Tools
-                    "com.apple.logic10",    // Logic Pro X
-                    "com.ableton.live",     // Ableton Live
-                    "com.cockos.reaper",    // Reaper
-                    "com.steinberg.cubase14", // Cubase
-                    "com.presonus.studioone2", // Studio One
-                    "com.uaudio.luna" // Luna
-                };
-
-                std::string bundleIDStr = [frontmostApp.bundleIdentifier UTF8String];
-                cachedIsDawFocused = (supportedDawBundleIDs.find(bundleIDStr) != supportedDawBundleIDs.end());
             }
         }
 
-        bool cachedIsDawFocused = false;
+        FaderEngine* engine = nullptr;
+        std::atomic<const DawProfile*> cachedProfile{nullptr};
         ScopedObserver* scopedObserver = nil;
     };
 
@@ -106,67 +114,101 @@ namespace
         return appObserver->isDawFocused();
     }
 
-    CFMachPortRef eventTap = nullptr;
-    CFRunLoopSourceRef runLoopSource = nullptr;
     FaderEngine* globalKeyEngine = nullptr;
-    std::unique_ptr<juce::Timer> retryTimer;
 
-    // validKeyCodes to block
-    const std::unordered_set<unsigned short> validKeyCodes =
+    // Keys whose key down was swallowed and are still held (event tap thread only)
+    std::array<bool, KeyBindings::numKeyCodes> swallowedKeys{};
+
+    // CGEvent timestamps are nanoseconds on the mach_absolute_time clock, which JUCE's high
+    // resolution ticks count in the timebase's own units
+    juce::int64 eventTimestampToTicks(CGEventTimestamp timestamp)
     {
-        0, 1, 2, 3, 5, 4, 38, 40, // a-k
-        12, 13, 14, 15, 17, 16, 32, 34, // q-i
-        18, 19  // 1-2
-    };
+        static const mach_timebase_info_data_t timebase = [] {
+            mach_timebase_info_data_t info{};
+            mach_timebase_info(&info);
+            return info;
+        }();
+
+        return (juce::int64)((__uint128_t)timestamp * timebase.denom / timebase.numer);
+    }
+
+    // The status bar is only touched on the main thread, and only when Caps Lock changes
+    void postCapsLockState(bool isCapsLockOn)
+    {
+        static std::atomic<int> lastState{-1};
+
+        if (lastState.exchange(isCapsLockOn ? 1 : 0) == (isCapsLockOn ? 1 : 0))
+            return;
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            TrayIconMac::updateCapsLockState(isCapsLockOn);
+        });
+    }
+
+    CFMachPortRef eventTap = nullptr;
 
     CGEventRef eventTapCallback(CGEventTapProxy proxy,
                                 CGEventType type,
                                 CGEventRef event,
                                 void* userInfo)
     {
-        if (type == kCGEventFlagsChanged)
+        // macOS turns a slow tap off, so turn it straight back on
+        if (type == kCGEventTapDisabledByTimeout || type == kCGEventTapDisabledByUserInput)
         {
-            // Read raw flags from the CGEventRef
-            static CGEventFlags lastFlags = 0;
-            CGEventFlags currentFlags = CGEventGetFlags(event);
+            if (eventTap != nullptr)
+                CGEventTapEnable(eventTap, true);
+            return event;
+        }
 
-            // Check if Caps Lock was toggled
-            if ((currentFlags & kCGEventFlagMaskAlphaShift) != (lastFlags & kCGEventFlagMaskAlphaShift))
-            {
-                bool isCapsLockOn = ((currentFlags & kCGEventFlagMaskAlphaShift) != 0);
-                TrayIconMac::updateCapsLockState(isCapsLockOn);
-            }
-            lastFlags = currentFlags;
+        if (type == kCGEventFlagsChanged)
+        {
+            // Caps Lock toggles show up as flag changes
+            postCapsLockState((CGEventGetFlags(event) & kCGEventFlagMaskAlphaShift) != 0);
         }
         else if ((type == kCGEventKeyDown || type == kCGEventKeyUp) && globalKeyEngine != nullptr)
         {
-            NSEvent* nsEvent = [NSEvent eventWithCGEvent:event];
-            if (nsEvent != nil)
+            const auto keyCode = (unsigned short)CGEventGetIntegerValueField(event, kCGKeyboardEventKeycode);
+            const bool isKeyDown = (type == kCGEventKeyDown);
+            const bool isRepeat = CGEventGetIntegerValueField(event, kCGKeyboardEventAutorepeat) != 0;
+
+            // Check Caps Lock state
+            const CGEventFlags flags = CGEventGetFlags(event);
+            const bool isCapsLockOn = ((flags & kCGEventFlagMaskAlphaShift) != 0);
+            postCapsLockState(isCapsLockOn);
+
+            // Shift picks coarse moves, Option and Control pick the surface
+            int modifiers = 0;
+            if ((flags & kCGEventFlagMaskShift) != 0)
+                modifiers |= KeyModifiers::shift;
+            if ((flags & kCGEventFlagMaskAlternate) != 0)
+                modifiers |= KeyModifiers::option;
+            if ((flags & kCGEventFlagMaskControl) != 0)
+                modifiers |= KeyModifiers::control;
+
+            if (keyCode >= swallowedKeys.size())
+                return event;
+
+            // Only swallow a key down if:
+            //    1) Caps-Lock is ON
+            //    2) The frontmost application is one of the DAWs
+            //    3) The engine's key map swallows keyCode
+            // Repeats and the key up go wherever the key down went, so neither the engine
+            // nor the focused app is left holding a key if Caps Lock changes in between
+            auto& isSwallowed = swallowedKeys[keyCode];
+            if (isKeyDown && !isRepeat)
+                isSwallowed = isCapsLockOn
+                              && isSupportedDawFocused()
+                              && globalKeyEngine->getKeyMap().lookup((int)keyCode).swallow;
+
+            if (isSwallowed)
             {
-                unsigned short keyCode = [nsEvent keyCode];
-                bool isKeyDown = (type == kCGEventKeyDown);
-                bool isShiftDown = (CGEventGetFlags(event) & kCGEventFlagMaskShift) != 0;
-
-                // Check Caps Lock state
-                CGEventFlags flags = CGEventGetFlags(event);
-                bool isCapsLockOn = ((flags & kCGEventFlagMaskAlphaShift) != 0);
-                TrayIconMac::updateCapsLockState(isCapsLockOn);
-
-                // Only swallow keystroke if:
-                //    1) Caps-Lock is ON
-                //    2) The frontmost application is one of the DAWs
-                //    3) keyCode is in 'validKeyCodes'
-                if (isCapsLockOn
-                    && isSupportedDawFocused()
-                    && (validKeyCodes.find(keyCode) != validKeyCodes.end()))
-                {
-                    juce::MessageManager::callAsync([=]()
-                    {
-                        if (globalKeyEngine != nullptr)
-                            globalKeyEngine->handleGlobalKeycode((int)keyCode, isKeyDown, isShiftDown);
-                    });
-                    return nullptr;  // Swallow event
-                }
+                if (!isKeyDown)
+                    isSwallowed = false;
+
+                // Hand off to the engine thread, stamped with when the OS captured the key
+                globalKeyEngine->postKeyEvent((int)keyCode, isKeyDown, modifiers, isRepeat,
+                                              eventTimestampToTicks(CGEventGetTimestamp(event)));
+                return nullptr;  // Swallow event
             }
         }
 
@@ -174,89 +216,107 @@ namespace
         return event;
     }
 
-    // Keep retrying to create the event tap until user grants permission
-    class EventTapRetryTimer : public juce::Timer
+    /**
+     * Runs the event tap on its own CFRunLoop, so key events never wait behind
+     * message thread work. Keeps retrying until the user grants Accessibility
+     * permission.
+     */
+    class EventTapThread : public juce::Thread
     {
     public:
-        EventTapRetryTimer() { startTimer(1000); }
+        EventTapThread() : juce::Thread("Fader Keys Event Tap") { startThread(juce::Thread::Priority::highest); }
 
-        void timerCallback() override
+        ~EventTapThread() override
         {
-            CGEventMask eventMask = (1 << kCGEventKeyDown) | (1 << kCGEventKeyUp) | (1 << kCGEventFlagsChanged);
-            auto newEventTap = CGEventTapCreate(kCGSessionEventTap,
-                                                kCGHeadInsertEventTap,
-                                                kCGEventTapOptionDefault,
-                                                eventMask,
-                                                eventTapCallback,
-                                                nullptr);
-
-            if (newEventTap)
+            signalThreadShouldExit();
+
             {
-                eventTap = newEventTap;
-                runLoopSource = CFMachPortCreateRunLoopSource(kCFAllocatorDefault, eventTap, 0);
-                CFRunLoopAddSource(CFRunLoopGetCurrent(), runLoopSource, kCFRunLoopCommonModes);
-                CGEventTapEnable(eventTap, true);
+                const juce::SpinLock::ScopedLockType sl(runLoopLock);
+                if (runLoop != nullptr)
+                    CFRunLoopStop(runLoop);
+            }
 
-                DBG("GlobalKeyListener successfully started after permission grant.");
-                retryTimer.reset();
+            notify();
+            stopThread(2000);
+        }
+
+        void run() override
+        {
+            const CGEventMask eventMask = (1 << kCGEventKeyDown) | (1 << kCGEventKeyUp) | (1 << kCGEventFlagsChanged);
+
+            while (!threadShouldExit())
+            {
+                eventTap = CGEventTapCreate(kCGSessionEventTap,
+                                            kCGHeadInsertEventTap,
+                                            kCGEventTapOptionDefault,
+                                            eventMask,
+                                            eventTapCallback,
+                                            nullptr);
+                if (eventTap != nullptr)
+                    break;
+
+                // Keep retrying to create the event tap until user grants permission
+                DBG("Failed to create event tap! Check Accessibility Permissions.");
+                wait(1000);
+            }
+
+            if (eventTap == nullptr)
+                return;
+
+            auto runLoopSource = CFMachPortCreateRunLoopSource(kCFAllocatorDefault, eventTap, 0);
+            CFRunLoopAddSource(CFRunLoopGetCurrent(), runLoopSource, kCFRunLoopCommonModes);
+            CGEventTapEnable(eventTap, true);
+
+            {
+                const juce::SpinLock::ScopedLockType sl(runLoopLock);
+                runLoop = CFRunLoopGetCurrent();
+            }
+
+            DBG("GlobalKeyListener started.");
+
+            // The destructor stops the run loop, the timeout covers a stop that came before it ran
+            while (!threadShouldExit())
+                CFRunLoopRunInMode(kCFRunLoopDefaultMode, 1.0, false);
+
+            {
+                const juce::SpinLock::ScopedLockType sl(runLoopLock);
+                runLoop = nullptr;
             }
+
+            CGEventTapEnable(eventTap, false);
+            CFRunLoopRemoveSource(CFRunLoopGetCurrent(), runLoopSource, kCFRunLoopCommonModes);
+            CFRelease(runLoopSource);
+            CFRelease(eventTap);
+            eventTap = nullptr;
+
+            DBG("GlobalKeyListener stopped.");
         }
+
+    private:
+        juce::SpinLock runLoopLock;
+        CFRunLoopRef runLoop = nullptr;
     };
+
+    std::unique_ptr<EventTapThread> eventTapThread;
 }
 
 void startGlobalKeyListener(FaderEngine* engine)
 {
-    if (eventTap != nullptr)
+    if (eventTapThread != nullptr)
         return;
 
     globalKeyEngine = engine;
 
     // Initialize the app observer
-    appObserver = std::make_unique<FrontmostAppObserver>();
+    appObserver = std::make_unique<FrontmostAppObserver>(engine);
 
-    CGEventMask eventMask = (1 << kCGEventKeyDown) | (1 << kCGEventKeyUp) | (1 << kCGEventFlagsChanged);
-    eventTap = CGEventTapCreate(kCGSessionEventTap,
-                                kCGHeadInsertEventTap,
-                                kCGEventTapOptionDefault,
-                                eventMask,
-                                eventTapCallback,
-                                nullptr);
-
-    if (!eventTap)
-    {
-        DBG("Failed to create event tap! Check Accessibility Permissions.");
-        // Start retry timer if we failed to create the event tap on first try
-        retryTimer = std::make_unique<EventTapRetryTimer>();
-        return;
-    }
-
-    runLoopSource = CFMachPortCreateRunLoopSource(kCFAllocatorDefault, eventTap, 0);
-    CFRunLoopAddSource(CFRunLoopGetCurrent(), runLoopSource, kCFRunLoopCommonModes);
-    CGEventTapEnable(eventTap, true);
-
-    DBG("GlobalKeyListener started.");
+    eventTapThread = std::make_unique<EventTapThread>();
 }
 
 void stopGlobalKeyListener()
 {
-    // Cancel any pending retry timer first
-    if (retryTimer != nullptr)
-    {
-        retryTimer->stopTimer();
-        retryTimer.reset();
-    }
-
-    if (eventTap != nullptr)
-    {
-        CGEventTapEnable(eventTap, false);
-        CFRunLoopRemoveSource(CFRunLoopGetCurrent(), runLoopSource, kCFRunLoopCommonModes);
-        CFRelease(runLoopSource);
-        runLoopSource = nullptr;
-        CFRelease(eventTap);
-        eventTap = nullptr;
-
-        DBG("GlobalKeyListener stopped.");
-    }
+    // Joins the tap thread, so no callback is running once it's gone
+    eventTapThread.reset();
 
     globalKeyEngine = nullptr;
     appObserver.reset();
@@ -0,0 +1,382 @@
+#include <JuceHeader.h>
+
+#if JUCE_LINUX
+
+#include "GlobalKeyListener.h"
+#include "FaderEngine.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <linux/uinput.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace
+{
+    // Evdev keyboard keys, button codes start at BTN_MISC (0x100)
+    constexpr int numEvdevKeys = 256;
+    constexpr int maxKeyboards = 16;
+    constexpr int maxEventNodes = 64;
+
+    // Events read per read() call, kept on the stack
+    constexpr int eventsPerRead = 64;
+
+    // How often /dev/input is checked for keyboards plugged in later
+    constexpr int rescanIntervalMs = 2000;
+
+    constexpr const char *virtualKeyboardName = "Fader Keys Virtual Keyboard";
+
+    // The key map is written in macOS virtual keycodes, so evdev codes are translated first
+    constexpr std::array<int16_t, numEvdevKeys> makeKeyCodeTable()
+    {
+        std::array<int16_t, numEvdevKeys> table{};
+        for (auto &keyCode : table)
+            keyCode = -1;
+
+        // EvdevCode, macOS KeyCode
+        constexpr int16_t pairs[][2] = {
+            {KEY_A, 0}, {KEY_S, 1}, {KEY_D, 2}, {KEY_F, 3}, {KEY_H, 4}, {KEY_G, 5},
+            {KEY_Z, 6}, {KEY_X, 7}, {KEY_C, 8}, {KEY_V, 9}, {KEY_B, 11}, {KEY_Q, 12},
+            {KEY_W, 13}, {KEY_E, 14}, {KEY_R, 15}, {KEY_Y, 16}, {KEY_T, 17},
+            {KEY_1, 18}, {KEY_2, 19}, {KEY_3, 20}, {KEY_4, 21}, {KEY_6, 22}, {KEY_5, 23},
+            {KEY_9, 25}, {KEY_7, 26}, {KEY_8, 28}, {KEY_0, 29},
+            {KEY_O, 31}, {KEY_U, 32}, {KEY_I, 34}, {KEY_P, 35}, {KEY_L, 37}, {KEY_J, 38},
+            {KEY_K, 40}, {KEY_N, 45}, {KEY_M, 46}};
+
+        for (const auto &pair : pairs)
+            table[(size_t)pair[0]] = pair[1];
+
+        return table;
+    }
+
+    constexpr auto KEYCODE_TABLE = makeKeyCodeTable();
+
+    constexpr bool testBit(const uint8_t *bits, int bit)
+    {
+        return (bits[bit / 8] & (1 << (bit % 8))) != 0;
+    }
+
+    int getModifierBit(int evdevCode)
+    {
+        switch (evdevCode)
+        {
+        case KEY_LEFTSHIFT:
+        case KEY_RIGHTSHIFT: return KeyModifiers::shift;
+        case KEY_LEFTALT:
+        case KEY_RIGHTALT: return KeyModifiers::option;
+        case KEY_LEFTCTRL:
+        case KEY_RIGHTCTRL: return KeyModifiers::control;
+        default: return 0;
+        }
+    }
+
+    //==============================================================================
+    /**
+     * Reads keyboards through evdev. Each keyboard is grabbed so Fader Keys sees
+     * its keys first, the same way the macOS event tap does. Keys the engine
+     * doesn't take are written back out through a uinput virtual keyboard.
+     */
+    class EvdevKeySource : private juce::Thread
+    {
+    public:
+        explicit EvdevKeySource(FaderEngine &engineToUse)
+            : juce::Thread("Fader Keys Key Source"),
+              engine(engineToUse)
+        {
+            startThread(juce::Thread::Priority::high);
+        }
+
+        ~EvdevKeySource() override
+        {
+            stopThread(1000);
+            closeKeyboards();
+            destroyVirtualKeyboard();
+        }
+
+    private:
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                // Keyboards are only grabbed once their keys can be passed back out
+                if (uinputFd < 0 && !createVirtualKeyboard())
+                {
+                    wait(1000);
+                    continue;
+                }
+
+                // Keyboards plugged in later are picked up on the next scan
+                const auto now = juce::Time::getMillisecondCounter();
+                if (now - lastScanMs >= (juce::uint32)rescanIntervalMs || numKeyboards == 0)
+                {
+                    lastScanMs = now;
+                    openKeyboards();
+
+                    if (numKeyboards == 0)
+                    {
+                        wait(1000);
+                        continue;
+                    }
+                }
+
+                // Short timeout so the thread notices when it should stop
+                if (poll(keyboardFds.data(), (nfds_t)numKeyboards, 100) <= 0)
+                    continue;
+
+                for (int i = numKeyboards; --i >= 0;)
+                {
+                    const auto revents = keyboardFds[(size_t)i].revents;
+
+                    if (revents & (POLLERR | POLLHUP | POLLNVAL))
+                    {
+                        // Unplugged
+                        closeKeyboard(i);
+                        continue;
+                    }
+
+                    if (revents & POLLIN)
+                        readKeyboard(keyboardFds[(size_t)i].fd);
+                }
+            }
+        }
+
+        void readKeyboard(int fd)
+        {
+            input_event events[eventsPerRead];
+            const auto bytesRead = read(fd, events, sizeof(events));
+
+            if (bytesRead <= 0)
+                return;
+
+            const auto numEvents = (size_t)bytesRead / sizeof(input_event);
+            for (size_t i = 0; i < numEvents; ++i)
+                handleEvent(events[i]);
+        }
+
+        void handleEvent(const input_event &event)
+        {
+            if (event.type == EV_SYN)
+            {
+                forwardEvent(event);
+                return;
+            }
+
+            if (event.type != EV_KEY)
+                return;
+
+            const int evdevCode = event.code;
+            const bool isKeyDown = event.value != 0;
+            const bool isRepeat = event.value == 2;
+
+            if (const int modifierBit = getModifierBit(evdevCode))
+                modifiers = isKeyDown ? (modifiers | modifierBit) : (modifiers & ~modifierBit);
+
+            if (evdevCode == KEY_CAPSLOCK && event.value == 1)
+                setCapsLock(!isCapsLockOn);
+
+            const int keyCode = evdevCode < numEvdevKeys ? KEYCODE_TABLE[(size_t)evdevCode] : -1;
+            if (keyCode < 0)
+            {
+                forwardEvent(event);
+                return;
+            }
+
+            // Only swallow a key down if Caps Lock is ON and the engine's key map swallows keyCode.
+            // There is no portable way to find the focused app here, so no DAW check is made.
+            // Repeats and the key up go wherever the key down went, so neither the engine nor
+            // the virtual keyboard is left holding a key if Caps Lock changes in between
+            auto &isSwallowed = swallowedKeys[(size_t)evdevCode];
+            if (isKeyDown && !isRepeat)
+                isSwallowed = isCapsLockOn && engine.getKeyMap().lookup(keyCode).swallow;
+
+            if (!isSwallowed)
+            {
+                forwardEvent(event);
+                return;
+            }
+
+            if (!isKeyDown)
+                isSwallowed = false;
+
+            engine.postKeyEvent(keyCode, isKeyDown, modifiers, isRepeat);
+        }
+
+        void forwardEvent(const input_event &event)
+        {
+            if (write(uinputFd, &event, sizeof(event)) != (ssize_t)sizeof(event))
+                DBG("Failed to forward key event");
+        }
+
+        void setCapsLock(bool shouldBeOn)
+        {
+            isCapsLockOn = shouldBeOn;
+
+            // Grabbed keyboards no longer get their LEDs from the desktop, so mirror Caps Lock here
+            const input_event events[] = {{{}, EV_LED, LED_CAPSL, shouldBeOn ? 1 : 0},
+                                          {{}, EV_SYN, SYN_REPORT, 0}};
+
+            for (int i = 0; i < numKeyboards; ++i)
+                if (write(keyboardFds[(size_t)i].fd, events, sizeof(events)) != (ssize_t)sizeof(events))
+                    DBG("Failed to set Caps Lock LED");
+        }
+
+        //==============================================================================
+        void openKeyboards()
+        {
+            const bool hadKeyboards = numKeyboards > 0;
+
+            for (int node = 0; node < maxEventNodes && numKeyboards < maxKeyboards; ++node)
+            {
+                if (isNodeOpen(node))
+                    continue;
+
+                const auto path = "/dev/input/event" + juce::String(node);
+                const int fd = open(path.toRawUTF8(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+
+                if (fd < 0)
+                    continue;
+
+                if (!isKeyboard(fd) || ioctl(fd, EVIOCGRAB, 1) != 0)
+                {
+                    close(fd);
+                    continue;
+                }
+
+                // Take Caps Lock from the first keyboard's LED, later ones are given it
+                if (numKeyboards == 0)
+                {
+                    uint8_t leds[(LED_CNT + 7) / 8]{};
+                    if (ioctl(fd, EVIOCGLED(sizeof(leds)), leds) >= 0)
+                        isCapsLockOn = testBit(leds, LED_CAPSL);
+                }
+
+                keyboardNodes[(size_t)numKeyboards] = node;
+                keyboardFds[(size_t)numKeyboards++] = {fd, POLLIN, 0};
+                DBG("Grabbed keyboard " << path);
+            }
+
+            if (numKeyboards == 0)
+                DBG("No keyboards could be grabbed! Check access to /dev/input.");
+            else if (hadKeyboards)
+                setCapsLock(isCapsLockOn);
+        }
+
+        bool isNodeOpen(int node) const
+        {
+            for (int i = 0; i < numKeyboards; ++i)
+                if (keyboardNodes[(size_t)i] == node)
+                    return true;
+
+            return false;
+        }
+
+        bool isKeyboard(int fd) const
+        {
+            char name[256]{};
+            ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name);
+
+            // Never grab our own output
+            if (std::strcmp(name, virtualKeyboardName) == 0)
+                return false;
+
+            uint8_t keyBits[(KEY_CNT + 7) / 8]{};
+            if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) < 0)
+                return false;
+
+            return testBit(keyBits, KEY_A) && testBit(keyBits, KEY_Q) && testBit(keyBits, KEY_CAPSLOCK);
+        }
+
+        void closeKeyboard(int index)
+        {
+            auto &keyboard = keyboardFds[(size_t)index];
+            ioctl(keyboard.fd, EVIOCGRAB, 0);
+            close(keyboard.fd);
+
+            --numKeyboards;
+            keyboard = keyboardFds[(size_t)numKeyboards];
+            keyboardNodes[(size_t)index] = keyboardNodes[(size_t)numKeyboards];
+        }
+
+        void closeKeyboards()
+        {
+            while (numKeyboards > 0)
+                closeKeyboard(numKeyboards - 1);
+        }
+
+        //==============================================================================
+        bool createVirtualKeyboard()
+        {
+            uinputFd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+            if (uinputFd < 0)
+            {
+                DBG("Failed to open /dev/uinput! Check access to /dev/uinput.");
+                return false;
+            }
+
+            ioctl(uinputFd, UI_SET_EVBIT, EV_KEY);
+            ioctl(uinputFd, UI_SET_EVBIT, EV_SYN);
+            for (int key = 1; key < numEvdevKeys; ++key)
+                ioctl(uinputFd, UI_SET_KEYBIT, key);
+
+            uinput_setup setup{};
+            setup.id.bustype = BUS_VIRTUAL;
+            std::strncpy(setup.name, virtualKeyboardName, UINPUT_MAX_NAME_SIZE - 1);
+
+            if (ioctl(uinputFd, UI_DEV_SETUP, &setup) != 0 || ioctl(uinputFd, UI_DEV_CREATE) != 0)
+            {
+                DBG("Failed to create virtual keyboard");
+                close(uinputFd);
+                uinputFd = -1;
+                return false;
+            }
+
+            return true;
+        }
+
+        void destroyVirtualKeyboard()
+        {
+            if (uinputFd < 0)
+                return;
+
+            ioctl(uinputFd, UI_DEV_DESTROY);
+            close(uinputFd);
+            uinputFd = -1;
+        }
+
+        FaderEngine &engine;
+
+        // Key source thread only
+        std::array<pollfd, maxKeyboards> keyboardFds{};
+        std::array<int, maxKeyboards> keyboardNodes{}; // /dev/input/event<node> of each grabbed keyboard
+        int numKeyboards = 0;
+        juce::uint32 lastScanMs = 0;
+        int uinputFd = -1;
+        bool isCapsLockOn = false;
+        int modifiers = 0;
+
+        // Keys whose key down was swallowed and are still held, by evdev code
+        std::array<bool, numEvdevKeys> swallowedKeys{};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EvdevKeySource)
+    };
+
+    std::unique_ptr<EvdevKeySource> keySource;
+}
+
+void startGlobalKeyListener(FaderEngine *engine)
+{
+    if (keySource != nullptr || engine == nullptr)
+        return;
+
+    keySource = std::make_unique<EvdevKeySource>(*engine);
+    DBG("GlobalKeyListener started.");
+}
+
+void stopGlobalKeyListener()
+{
+    keySource.reset();
+}
+
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+/** Modifier keys held during a key event, as a bitmask */
+namespace KeyModifiers
+{
+    constexpr int shift = 1 << 0;   // Coarse nudges, bank by 8
+    constexpr int option = 1 << 1;  // Surface layer select
+    constexpr int control = 1 << 2; // Surface layer select
+}
+
+/** A single key transition captured by the global key listener */
+struct KeyEvent
+{
+    int keyCode;
+    bool isKeyDown;
+    bool isRepeat; // OS autorepeat of a key that is already down
+    int modifiers; // KeyModifiers bitmask
+    juce::int64 timestampTicks; // juce::Time::getHighResolutionTicks() when the OS captured it
+};
+
+/**
+ * Lock-free single-producer/single-consumer ring of key events.
+ * The key listener pushes from the event tap, the engine thread pops.
+ */
+class KeyEventQueue
+{
+public:
+    static constexpr int capacity = 256;
+
+    /** Producer side. Returns false (and drops the event) if the queue is full */
+    bool push(const KeyEvent &event)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+        if (size1 + size2 < 1)
+            return false;
+
+        events[(size_t)(size1 > 0 ? start1 : start2)] = event;
+        fifo.finishedWrite(1);
+        return true;
+    }
+
+    /** Consumer side. Returns false if there is nothing to read */
+    bool pop(KeyEvent &event)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(1, start1, size1, start2, size2);
+
+        if (size1 + size2 < 1)
+            return false;
+
+        event = events[(size_t)(size1 > 0 ? start1 : start2)];
+        fifo.finishedRead(1);
+        return true;
+    }
+
+private:
+    juce::AbstractFifo fifo{capacity};
+    std::array<KeyEvent, capacity> events{};
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "FaderRamp.h"
+#include "MidiEncoding.h"
+
+/** What a key does when Fader Keys is capturing the keyboard */
+struct KeyAction
+{
+    enum class Type : uint8_t
+    {
+        None,
+        FaderUp,
+        FaderDown,
+        Bank,
+        Snapshot, // Recall a scene snapshot, store it with shift
+        Ramp      // Glide faders to a level over a set time
+    };
+
+    // A ramp with this fader index moves the fader whose key was pressed last
+    static constexpr uint8_t lastFaderKey = 0xFF;
+
+    Type type = Type::None;
+    uint8_t faderIndex = 0;
+    MidiEncoding::BankAction bank = MidiEncoding::BankAction::Left;         // Without shift
+    MidiEncoding::BankAction shiftedBank = MidiEncoding::BankAction::Left8; // With shift
+    bool swallow = false; // Hide the key from the focused app
+    uint8_t snapshotSlot = 0;
+    FaderRamp::Shape rampShape = FaderRamp::Shape::Linear;
+    float rampTargetDb = 0.0f;
+    uint16_t rampDurationMs = 0;
+};
+
+/** Keycode bindings and the dense tables built from them */
+namespace KeyBindings
+{
+    constexpr int numKeyCodes = 128;
+    using Table = std::array<KeyAction, numKeyCodes>;
+
+    struct Binding
+    {
+        int keyCode;
+        KeyAction action;
+    };
+
+    constexpr KeyAction faderKey(int faderIndex, bool isUpward)
+    {
+        return {isUpward ? KeyAction::Type::FaderUp : KeyAction::Type::FaderDown,
+                static_cast<uint8_t>(faderIndex),
+                MidiEncoding::BankAction::Left,
+                MidiEncoding::BankAction::Left8,
+                true};
+    }
+
+    constexpr KeyAction bankKey(MidiEncoding::BankAction bank, MidiEncoding::BankAction shiftedBank)
+    {
+        return {KeyAction::Type::Bank, 0, bank, shiftedBank, true};
+    }
+
+    constexpr KeyAction snapshotKey(int slot)
+    {
+        return {KeyAction::Type::Snapshot, 0, MidiEncoding::BankAction::Left, MidiEncoding::BankAction::Left8, true,
+                static_cast<uint8_t>(slot)};
+    }
+
+    constexpr KeyAction rampKey(int faderIndex, float targetDb, int durationMs, FaderRamp::Shape shape)
+    {
+        return {KeyAction::Type::Ramp, static_cast<uint8_t>(faderIndex), MidiEncoding::BankAction::Left,
+                MidiEncoding::BankAction::Left8, true, 0, shape, targetDb, static_cast<uint16_t>(durationMs)};
+    }
+
+    /** Expands a list of bindings into a table indexed by keycode */
+    constexpr Table buildTable(const Binding *bindings, size_t numBindings)
+    {
+        Table table{};
+        for (size_t i = 0; i < numBindings; ++i)
+            if (bindings[i].keyCode >= 0 && bindings[i].keyCode < numKeyCodes)
+                table[(size_t)bindings[i].keyCode] = bindings[i].action;
+        return table;
+    }
+
+    // Default macOS virtual keycode layout
+    inline constexpr std::array<Binding, 24> defaultBindings{{
+        // KeyCode, Action
+        // Fader 1 controls
+        {12, faderKey(0, true)},  // Q - Fader 1 Up
+        {0, faderKey(0, false)},  // A - Fader 1 Down
+        // Fader 2 controls
+        {13, faderKey(1, true)},  // W - Fader 2 Up
+        {1, faderKey(1, false)},  // S - Fader 2 Down
+        // Fader 3 controls
+        {14, faderKey(2, true)},  // E - Fader 3 Up
+        {2, faderKey(2, false)},  // D - Fader 3 Down
+        // Fader 4 controls
+        {15, faderKey(3, true)},  // R - Fader 4 Up
+        {3, faderKey(3, false)},  // F - Fader 4 Down
+        // Fader 5 controls
+        {17, faderKey(4, true)},  // T - Fader 5 Up
+        {5, faderKey(4, false)},  // G - Fader 5 Down
+        // Fader 6 controls
+        {16, faderKey(5, true)},  // Y - Fader 6 Up
+        {4, faderKey(5, false)},  // H - Fader 6 Down
+        // Fader 7 controls
+        {32, faderKey(6, true)},  // U - Fader 7 Up
+        {38, faderKey(6, false)}, // J - Fader 7 Down
+        // Fader 8 controls
+        {34, faderKey(7, true)},  // I - Fader 8 Up
+        {40, faderKey(7, false)}, // K - Fader 8 Down
+        // Bank controls, shift banks by 8
+        {18, bankKey(MidiEncoding::BankAction::Left, MidiEncoding::BankAction::Left8)},  // 1 - Bank Left
+        {19, bankKey(MidiEncoding::BankAction::Right, MidiEncoding::BankAction::Right8)}, // 2 - Bank Right
+        // Scene snapshots, shift stores
+        {20, snapshotKey(0)}, // 3 - Snapshot 1
+        {21, snapshotKey(1)}, // 4 - Snapshot 2
+        {23, snapshotKey(2)}, // 5 - Snapshot 3
+        {22, snapshotKey(3)}, // 6 - Snapshot 4
+        // Ramps on the last fader moved (and its group)
+        {26, rampKey(KeyAction::lastFaderKey, (float)FaderTaper::floorDb, 4000, FaderRamp::Shape::LogTaper)}, // 7 - Fade out over 4 s
+        {28, rampKey(KeyAction::lastFaderKey, 0.0f, 500, FaderRamp::Shape::SCurve)}                           // 8 - Unity over 500 ms
+    }};
+
+    inline constexpr Table defaultTable = buildTable(defaultBindings.data(), defaultBindings.size());
+}
+
+/**
+ * The active keycode -> action table, shared by the key listener and the engine.
+ * Remapping points it at another table (each DAW profile owns one), so a
+ * lookup from any thread stays a single array index.
+ */
+class KeyMap
+{
+public:
+    /** The action for a keycode. Safe to call from any thread */
+    const KeyAction &lookup(int keyCode) const noexcept
+    {
+        static constexpr KeyAction noAction{};
+
+        if (keyCode < 0 || keyCode >= KeyBindings::numKeyCodes)
+            return noAction;
+
+        return (*activeTable.load(std::memory_order_acquire))[(size_t)keyCode];
+    }
+
+    /** Uses a table owned elsewhere, which must outlive the key map. Call from the message thread */
+    void setTable(const KeyBindings::Table *table)
+    {
+        activeTable.store(table, std::memory_order_release);
+    }
+
+private:
+    std::atomic<const KeyBindings::Table *> activeTable{&KeyBindings::defaultTable};
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/**
+ * Fixed-size latency histogram with power-of-two microsecond buckets.
+ * Recording is O(1) and never allocates, so it is safe on the engine thread.
+ * Buckets are relaxed atomics, so any thread may record into or read from it.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int numBuckets = 24; // 1us .. ~8s
+
+    void record(juce::int64 elapsedTicks)
+    {
+        recordMicros(juce::Time::highResolutionTicksToSeconds(elapsedTicks) * 1.0e6);
+    }
+
+    void recordMicros(double micros)
+    {
+        buckets[(size_t)bucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    juce::int64 getCount() const { return count.load(std::memory_order_relaxed); }
+
+    /** Upper bound in microseconds of the bucket holding the given percentile (0-100) */
+    juce::int64 getPercentileMicros(double percentile) const
+    {
+        const auto total = getCount();
+        if (total == 0)
+            return 0;
+
+        const auto target = juce::jmin(total - 1, (juce::int64)((double)total * percentile / 100.0));
+        juce::int64 seen = 0;
+
+        for (int i = 0; i < numBuckets; ++i)
+        {
+            seen += buckets[(size_t)i].load(std::memory_order_relaxed);
+            if (seen > target)
+                return (juce::int64)1 << i;
+        }
+
+        return (juce::int64)1 << (numBuckets - 1);
+    }
+
+    /** Counts recorded while resetting may survive it */
+    void reset()
+    {
+        for (auto &bucket : buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static int bucketFor(double micros)
+    {
+        int bucket = 0;
+        while (bucket < numBuckets - 1 && micros > (double)((juce::int64)1 << bucket))
+            ++bucket;
+        return bucket;
+    }
+
+    std::array<std::atomic<juce::int64>, numBuckets> buckets{};
+    std::atomic<juce::int64> count{0};
+};
@@ -0,0 +1,400 @@
+#include "LatencyProbe.h"
+
+namespace
+{
+    constexpr const char *probeFlag = "--latency-probe";
+    constexpr int defaultNumSamples = 1000;
+
+    // The first surface's ports, seen from the DAW side
+    constexpr const char *engineOutputName = "Fader Keys MIDI Output";
+    constexpr const char *engineInputName = "Fader Keys MIDI Input";
+
+    // How long to wait for one response before counting it as missed
+    constexpr int responseTimeoutMs = 100;
+
+    // Gap between samples, longer than the engine's default per-fader rate limit
+    constexpr int sampleIntervalMs = 20;
+
+    // Fader 1 up/down keys from the default key map
+    constexpr int faderUpKeyCode = 12;  // Q
+    constexpr int faderDownKeyCode = 0; // A
+
+    // Snapshot 1 key from the default key map, shift stores
+    constexpr int snapshotKeyCode = 20; // 3
+
+    // A recall takes far longer than one key response, so it gets fewer samples
+    constexpr int samplesPerRecall = 10;
+
+    bool isPingReply(const juce::uint8 *data, int size)
+    {
+        return size == (int)MidiEncoding::huiPingReply.size()
+               && std::equal(MidiEncoding::huiPingReply.begin(), MidiEncoding::huiPingReply.end(), data);
+    }
+
+    // Pitch wheel (MCU) or fader MSB/LSB controller (HUI) on channel 1
+    bool isFaderPosition(const juce::uint8 *data, int size)
+    {
+        if (size != 3)
+            return false;
+
+        if ((data[0] & 0xF0) == MidiEncoding::pitchWheelStatus)
+            return true;
+
+        return data[0] == MidiEncoding::controllerStatus
+               && (data[1] < 0x08 || (data[1] >= 0x20 && data[1] < 0x28));
+    }
+
+    template <size_t Size>
+    void sendBurst(juce::MidiOutput &output, const std::array<uint8_t, Size> &burst)
+    {
+        for (size_t i = 0; i < Size; i += MidiEncoding::messageSize)
+            output.sendMessageNow(juce::MidiMessage(burst.data() + i, (int)MidiEncoding::messageSize));
+    }
+
+    // A fader position as the host sends it
+    void sendHostPosition(juce::MidiOutput &output, ControlProtocol protocol, int faderIndex, int value)
+    {
+        if (protocol == ControlProtocol::Hui)
+        {
+            // MSB then LSB, the engine publishes the position on the LSB
+            const auto fader = (uint8_t)faderIndex;
+            const std::array<uint8_t, 6> position{MidiEncoding::controllerStatus, fader, (uint8_t)(value >> 7),
+                                                  MidiEncoding::controllerStatus, (uint8_t)(0x20 | fader),
+                                                  (uint8_t)(value & 0x7F)};
+            sendBurst(output, position);
+        }
+        else
+        {
+            sendBurst(output, MidiEncoding::pitchWheel(faderIndex, value));
+        }
+    }
+
+    void logHistogram(const juce::String &name, const LatencyHistogram &histogram)
+    {
+        juce::Logger::writeToLog(name + ": n=" + juce::String(histogram.getCount())
+                                 + " p50=" + juce::String(histogram.getPercentileMicros(50.0))
+                                 + "us p99=" + juce::String(histogram.getPercentileMicros(99.0))
+                                 + "us max=" + juce::String(histogram.getPercentileMicros(100.0)) + "us");
+    }
+}
+
+// CONSTRUCTOR / DESTRUCTOR
+//==============================================================================
+LatencyProbe::LatencyProbe(FaderEngine &engineToProbe, ControlProtocol protocolToUse, int numSamplesToTake)
+    : juce::Thread("Fader Keys Latency Probe"),
+      engine(engineToProbe),
+      protocol(protocolToUse),
+      numSamples(juce::jmax(1, numSamplesToTake))
+{
+    startThread();
+}
+
+LatencyProbe::~LatencyProbe()
+{
+    stopThread(2000);
+
+    if (fromEngine != nullptr)
+    {
+        fromEngine->stop();
+        fromEngine.reset();
+    }
+    toEngine.reset();
+}
+
+bool LatencyProbe::isRequested(const juce::String &commandLine)
+{
+    return commandLine.contains(probeFlag);
+}
+
+std::unique_ptr<LatencyProbe> LatencyProbe::createFromCommandLine(FaderEngine &engine, const juce::String &commandLine)
+{
+    // --latency-probe [hui|mcu] [samples]
+    const auto args = juce::StringArray::fromTokens(commandLine, true);
+    const int flagIndex = args.indexOf(probeFlag);
+
+    const auto protocol = args[flagIndex + 1].equalsIgnoreCase("hui") ? ControlProtocol::Hui
+                                                                      : ControlProtocol::Mcu;
+    const int numSamples = args[flagIndex + 2].getIntValue();
+
+    return std::make_unique<LatencyProbe>(engine, protocol, numSamples > 0 ? numSamples : defaultNumSamples);
+}
+
+// PROBE THREAD
+//==============================================================================
+void LatencyProbe::run()
+{
+    int result = 1;
+
+    if (connect())
+    {
+        // Host feedback goes first so the engine detects the protocol before any key is sent
+        measureFeedback();
+
+        if (protocol == ControlProtocol::Hui)
+            measurePings();
+
+        measureKeys();
+        measureRecall();
+
+        // Nothing else is recorded on the MIDI input thread from here on
+        fromEngine->stop();
+        result = report();
+    }
+    else
+    {
+        juce::Logger::writeToLog("Latency probe: could not open the Fader Keys MIDI ports");
+    }
+
+    juce::MessageManager::callAsync([result] {
+        if (auto *app = juce::JUCEApplicationBase::getInstance())
+            app->setApplicationReturnValue(result);
+
+        juce::JUCEApplicationBase::quit();
+    });
+}
+
+bool LatencyProbe::connect()
+{
+    // Virtual ports can take a moment to show up in the device lists
+    for (int attempt = 0; attempt < 20 && !threadShouldExit(); ++attempt)
+    {
+        if (toEngine == nullptr)
+            for (const auto &device : juce::MidiOutput::getAvailableDevices())
+                if (device.name == engineInputName)
+                    toEngine = juce::MidiOutput::openDevice(device.identifier);
+
+        if (fromEngine == nullptr && toEngine != nullptr)
+            for (const auto &device : juce::MidiInput::getAvailableDevices())
+                if (device.name == engineOutputName)
+                    fromEngine = juce::MidiInput::openDevice(device.identifier, this);
+
+        if (toEngine != nullptr && fromEngine != nullptr)
+        {
+            fromEngine->start();
+            return true;
+        }
+
+        wait(100);
+    }
+
+    return false;
+}
+
+void LatencyProbe::measureFeedback()
+{
+    for (int i = 0; i < numSamples && !threadShouldExit(); ++i)
+    {
+        // Alternate between two positions so every sample is a change
+        const int value = (i % 2 == 0) ? 4096 : 12288;
+        const auto start = juce::Time::getHighResolutionTicks();
+        sendHostPosition(*toEngine, protocol, 0, value);
+
+        // The engine's fader state is polled, so this includes the decode and the atomic store
+        const auto deadline = start + juce::Time::getHighResolutionTicksPerSecond() * responseTimeoutMs / 1000;
+        auto now = start;
+        while (engine.getFaderValue(0) != value && now < deadline)
+        {
+            juce::Thread::yield();
+            now = juce::Time::getHighResolutionTicks();
+        }
+
+        if (now < deadline)
+            feedbackToState.record(now - start);
+        else
+            ++numMissed;
+    }
+}
+
+void LatencyProbe::measurePings()
+{
+    static constexpr uint8_t ping[] = {MidiEncoding::noteOnStatus, 0x00, 0x00};
+
+    for (int i = 0; i < numSamples && !threadShouldExit(); ++i)
+    {
+        responseReceived.reset();
+        pendingPingTicks.store(juce::Time::getHighResolutionTicks());
+        toEngine->sendMessageNow(juce::MidiMessage(ping, (int)sizeof(ping)));
+
+        if (!responseReceived.wait(responseTimeoutMs))
+        {
+            pendingPingTicks.store(0);
+            ++numMissed;
+        }
+
+        wait(sampleIntervalMs);
+    }
+}
+
+void LatencyProbe::measureKeys()
+{
+    for (int i = 0; i < numSamples && !threadShouldExit(); ++i)
+    {
+        // Up then down, so the fader ends where it started
+        const int keyCode = (i % 2 == 0) ? faderUpKeyCode : faderDownKeyCode;
+
+        responseReceived.reset();
+        pendingKeyTicks.store(juce::Time::getHighResolutionTicks());
+        engine.postKeyEvent(keyCode, true, 0);
+
+        if (!responseReceived.wait(responseTimeoutMs))
+        {
+            pendingKeyTicks.store(0);
+            ++numMissed;
+        }
+
+        engine.postKeyEvent(keyCode, false, 0);
+
+        // Lets the release go out before the next sample starts
+        wait(sampleIntervalMs);
+    }
+}
+
+bool LatencyProbe::moveAllFaders(int value)
+{
+    for (int i = 0; i < FaderState::numFaders; ++i)
+        sendHostPosition(*toEngine, protocol, i, value);
+
+    const auto deadline = juce::Time::getHighResolutionTicks()
+                          + juce::Time::getHighResolutionTicksPerSecond() * responseTimeoutMs / 1000;
+
+    for (int i = 0; i < FaderState::numFaders; ++i)
+    {
+        while (engine.getFaderValue(i) != value)
+        {
+            if (juce::Time::getHighResolutionTicks() >= deadline || threadShouldExit())
+                return false;
+
+            juce::Thread::yield();
+        }
+    }
+
+    return true;
+}
+
+void LatencyProbe::measureRecall()
+{
+    const int numRecalls = juce::jmax(1, numSamples / samplesPerRecall);
+
+    // Every recall message can be held back by the pacing, plus the usual response time
+    const int recallTimeoutMs = 3 * FaderState::numFaders * engine.getRecallPacingMs() + responseTimeoutMs;
+
+    // Store every fader at one position, then move them all away before each recall
+    if (!moveAllFaders(12288))
+    {
+        ++numMissed;
+        return;
+    }
+
+    engine.postKeyEvent(snapshotKeyCode, true, KeyModifiers::shift);
+    engine.postKeyEvent(snapshotKeyCode, false, KeyModifiers::shift);
+    wait(sampleIntervalMs);
+
+    for (int i = 0; i < numRecalls && !threadShouldExit(); ++i)
+    {
+        if (!moveAllFaders((i % 2 == 0) ? 4096 : 8192))
+        {
+            ++numMissed;
+            continue;
+        }
+
+        responseReceived.reset();
+        pendingRecallTicks.store(juce::Time::getHighResolutionTicks());
+        engine.postKeyEvent(snapshotKeyCode, true, 0);
+
+        if (!responseReceived.wait(recallTimeoutMs))
+        {
+            pendingRecallTicks.store(0);
+            ++numMissed;
+        }
+
+        engine.postKeyEvent(snapshotKeyCode, false, 0);
+        wait(sampleIntervalMs);
+    }
+}
+
+int LatencyProbe::report() const
+{
+    juce::Logger::writeToLog("Latency probe (" + juce::String(protocol == ControlProtocol::Hui ? "HUI" : "MCU")
+                             + ", " + juce::String(numSamples) + " samples)");
+
+    logHistogram("Key to MIDI", keyToMidi);
+    logHistogram("Feedback to fader state", feedbackToState);
+    logHistogram("Recall to settled", recallToSettled);
+
+    if (protocol == ControlProtocol::Hui)
+        logHistogram("Ping round trip", pingRoundTrip);
+
+    juce::Logger::writeToLog("Missed responses: " + juce::String(numMissed));
+
+    return numMissed == 0 ? 0 : 1;
+}
+
+// INCOMING MIDI MESSAGE HANDLING
+//==============================================================================
+bool LatencyProbe::isLastFaderRelease(const juce::uint8 *data, int size)
+{
+    if (size != 3)
+        return false;
+
+    constexpr int lastFader = FaderState::numFaders - 1;
+    const auto mcuRelease = MidiEncoding::mcuRelease(lastFader);
+
+    if (std::equal(mcuRelease.begin(), mcuRelease.end(), data))
+        return true;
+
+    // HUI releases with a zone select followed by the port off
+    const auto huiRelease = MidiEncoding::huiRelease(lastFader);
+
+    if (data[0] != MidiEncoding::controllerStatus)
+        return false;
+
+    if (data[1] == huiRelease[1])
+    {
+        lastFaderZoneSelected = data[2] == huiRelease[2];
+        return false;
+    }
+
+    if (data[1] == huiRelease[4])
+        return std::exchange(lastFaderZoneSelected, false) && data[2] == huiRelease[5];
+
+    return false;
+}
+
+void LatencyProbe::handleIncomingMidiMessage(juce::MidiInput *, const juce::MidiMessage &message)
+{
+    const auto now = juce::Time::getHighResolutionTicks();
+    const auto *data = message.getRawData();
+    const int size = message.getRawDataSize();
+
+    if (isPingReply(data, size))
+    {
+        if (const auto start = pendingPingTicks.exchange(0))
+        {
+            pingRoundTrip.record(now - start);
+            responseReceived.signal();
+        }
+        return;
+    }
+
+    // A recall goes fader by fader, so it has settled once the last fader is released
+    if (isLastFaderRelease(data, size))
+    {
+        if (const auto start = pendingRecallTicks.exchange(0))
+        {
+            recallToSettled.record(now - start);
+            responseReceived.signal();
+        }
+        return;
+    }
+
+    // The first message after a key event is the key's response
+    if (const auto start = pendingKeyTicks.exchange(0))
+    {
+        keyToMidi.record(now - start);
+        responseReceived.signal();
+    }
+
+    // A DAW echoes every fader position it accepts
+    if (isFaderPosition(data, size))
+        toEngine->sendMessageNow(message);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "FaderEngine.h"
+#include "LatencyHistogram.h"
+
+/**
+ * Headless loopback check that plays the DAW on the other end of the Fader Keys
+ * ports, so latency can be measured without a Pro Tools or Logic session.
+ *
+ * Started with `--latency-probe [hui|mcu] [samples]`. It answers like a HUI or
+ * MCU host (pings, echoed fader positions), posts synthetic key events to the
+ * engine and logs these histograms:
+ *  - key to MIDI: key event posted -> first message back from the engine
+ *  - feedback: host fader position sent -> engine's fader state updated
+ *  - ping round trip (HUI only): host ping sent -> engine's reply received
+ *  - recall to settled: snapshot key posted -> last fader's release received
+ */
+class LatencyProbe : private juce::Thread,
+                     private juce::MidiInputCallback
+{
+public:
+    LatencyProbe(FaderEngine &engineToProbe, ControlProtocol protocolToUse, int numSamplesToTake);
+    ~LatencyProbe() override;
+
+    /** True if the command line asks for the probe instead of the normal app */
+    static bool isRequested(const juce::String &commandLine);
+
+    /** Builds a probe from the command line arguments */
+    static std::unique_ptr<LatencyProbe> createFromCommandLine(FaderEngine &engine, const juce::String &commandLine);
+
+private:
+    void run() override;
+    void handleIncomingMidiMessage(juce::MidiInput *source, const juce::MidiMessage &message) override;
+
+    /** Opens the other end of the engine's first port pair */
+    bool connect();
+
+    // Measurement phases (probe thread)
+    void measureFeedback();
+    void measurePings();
+    void measureKeys();
+    void measureRecall();
+
+    /** Sends every fader of the first surface to a position as the host, and waits for the engine to take it */
+    bool moveAllFaders(int value);
+
+    /** True for the last message of the eighth fader's release (MIDI input thread) */
+    bool isLastFaderRelease(const juce::uint8 *data, int size);
+
+    /** Logs the results and returns the process exit code */
+    int report() const;
+
+    FaderEngine &engine;
+    const ControlProtocol protocol;
+    const int numSamples;
+
+    // The DAW side of the engine's ports
+    std::unique_ptr<juce::MidiOutput> toEngine;
+    std::unique_ptr<juce::MidiInput> fromEngine;
+
+    // Start of the measurement waiting on the MIDI input thread, 0 when none
+    std::atomic<juce::int64> pendingKeyTicks{0};
+    std::atomic<juce::int64> pendingPingTicks{0};
+    std::atomic<juce::int64> pendingRecallTicks{0};
+    juce::WaitableEvent responseReceived;
+
+    // Recorded on the MIDI input thread, read once it is closed
+    LatencyHistogram keyToMidi;
+    LatencyHistogram pingRoundTrip;
+    LatencyHistogram recallToSettled;
+    bool lastFaderZoneSelected = false;
+
+    // Probe thread only
+    LatencyHistogram feedbackToState;
+    int numMissed = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LatencyProbe)
+};
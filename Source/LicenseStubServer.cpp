@@ -0,0 +1,184 @@
+#include "LicenseStubServer.h"
+
+#if JUCE_DEBUG
+
+#include "LicenseToken.h"
+
+namespace
+{
+    constexpr const char *stubFlag = "--license-stub";
+
+    // Requests are tiny, anything bigger is not ours
+    constexpr int maxRequestBytes = 8192;
+    constexpr int readTimeoutMs = 2000;
+
+    // Private half of the development key in LicenseToken.cpp. Debug builds only, never used for release tokens
+    constexpr const char *developmentPrivateKey =
+        "30de887600a5f6230dd1867678a85754ea2a9acc5e98cc180e19765a824e7fee"
+        "c892be96ebf5e8ffd4fcc966b4827bd3b20f41638de2ffc84d7d7ddda4906768"
+        "61a1edfcc7ad9def042ca19a43c1a296702742bc48cd25c75c29d8217f5efbcc"
+        "20b4fa22a6eacfd55892e1a4b1caf683f3ea56f4919e26916eed5cf06e0522a4"
+        "af260486220a41dccd727ee0d199184c85a2af7aa36f74e9ba0acee5bdaa06ec"
+        "5838d31cf5af780a5595ee78f3ae6e1bf049592e74a3b829f55bb601144b5a65"
+        "01b1cc7aefc9b2a81d1a870df279e56905eaa015037781979cb8e8ceb3662a5c"
+        "4ff300b5838643bbaf75e48d42b4355b7af9c7d2cabac27d86d5647fd173ec61"
+        ","
+        "b33d5fbb97366e933c9e424305dd3a7e4173e1ed7021bc42a6c5bb5c061e2204"
+        "1e7b195512e3394f9f1a0f1b8acb5ffff83f9a7dc3ef6ef1d028d9def43b2b6d"
+        "cb70691564756ae8bde9849631a427be6c103b13db8b5483b1222700b00e41f6"
+        "6c2b64d5a104f5f00806bc9b7ef7965ddc92e44887ea487948c1953f54d84273"
+        "ba415feece81b9e327552f9ecdcbf261adf82d0e71fc72757169ada4e4860e54"
+        "857eba1f9aa9f6c13912592ac3d7907b694d9836449351753318f8d237688ac9"
+        "581ab5a59f7a37d69b6f317bbe3876ba57ac4bd6bc45ec43f28c507d6abb766a"
+        "7d528f29a63938d033e376df7242ecac8005d8c84fa0f2c50be81689509621cb";
+
+    void writeResponse(juce::StreamingSocket &connection, int statusCode, const juce::String &statusText,
+                       const juce::var &body)
+    {
+        const auto json = juce::JSON::toString(body, true);
+        const auto utf8 = json.toUTF8();
+        const auto numBodyBytes = utf8.sizeInBytes() - 1;
+
+        juce::String response;
+        response << "HTTP/1.1 " << statusCode << " " << statusText << "\r\n"
+                 << "Content-Type: application/json\r\n"
+                 << "Content-Length: " << (int)numBodyBytes << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << json;
+
+        const auto responseUtf8 = response.toUTF8();
+        connection.write(responseUtf8.getAddress(), (int)responseUtf8.sizeInBytes() - 1);
+    }
+}
+
+// CONSTRUCTOR / DESTRUCTOR
+//==============================================================================
+LicenseStubServer::LicenseStubServer(int portToListenOn, int replyDelayMs)
+    : juce::Thread("Fader Keys License Stub"),
+      port(portToListenOn),
+      delayMs(juce::jmax(0, replyDelayMs))
+{
+    startThread();
+}
+
+LicenseStubServer::~LicenseStubServer()
+{
+    signalThreadShouldExit();
+    listener.close();
+    stopThread(2000);
+}
+
+bool LicenseStubServer::isRequested(const juce::String &commandLine)
+{
+    return commandLine.contains(stubFlag);
+}
+
+std::unique_ptr<LicenseStubServer> LicenseStubServer::createFromCommandLine(const juce::String &commandLine)
+{
+    // --license-stub [port] [--delay <ms>]
+    const auto args = juce::StringArray::fromTokens(commandLine, true);
+    const int flagIndex = args.indexOf(stubFlag);
+    const int delayIndex = args.indexOf("--delay");
+
+    const int portArg = args[flagIndex + 1].getIntValue();
+    const int delayArg = delayIndex >= 0 ? args[delayIndex + 1].getIntValue() : 0;
+
+    return std::make_unique<LicenseStubServer>(portArg > 0 ? portArg : defaultPort, delayArg);
+}
+
+// SERVER THREAD
+//==============================================================================
+void LicenseStubServer::run()
+{
+    if (!listener.createListener(port, "127.0.0.1"))
+    {
+        juce::Logger::writeToLog("License stub: could not listen on port " + juce::String(port));
+
+        juce::MessageManager::callAsync([] {
+            if (auto *app = juce::JUCEApplicationBase::getInstance())
+                app->setApplicationReturnValue(1);
+
+            juce::JUCEApplicationBase::quit();
+        });
+        return;
+    }
+
+    juce::Logger::writeToLog("License stub: listening on http://127.0.0.1:" + juce::String(port) + "/api/auth/serial");
+
+    while (!threadShouldExit())
+    {
+        std::unique_ptr<juce::StreamingSocket> connection(listener.waitForNextConnection());
+        if (connection == nullptr)
+            continue;
+
+        handleConnection(*connection);
+    }
+}
+
+void LicenseStubServer::handleConnection(juce::StreamingSocket &connection)
+{
+    // Read the headers, then as much body as Content-Length asks for
+    juce::MemoryBlock request;
+    int headerEnd = -1;
+    int contentLength = 0;
+
+    while (request.getSize() < (size_t)maxRequestBytes && !threadShouldExit())
+    {
+        if (connection.waitUntilReady(true, readTimeoutMs) != 1)
+            return;
+
+        char buffer[1024];
+        const int numRead = connection.read(buffer, (int)sizeof(buffer), false);
+        if (numRead <= 0)
+            return;
+
+        request.append(buffer, (size_t)numRead);
+        const auto text = request.toString();
+
+        if (headerEnd < 0)
+        {
+            headerEnd = text.indexOf("\r\n\r\n");
+            if (headerEnd >= 0)
+            {
+                for (const auto &line : juce::StringArray::fromLines(text.substring(0, headerEnd)))
+                    if (line.startsWithIgnoreCase("Content-Length:"))
+                        contentLength = line.fromFirstOccurrenceOf(":", false, false).trim().getIntValue();
+            }
+        }
+
+        if (headerEnd >= 0 && (int)request.getSize() >= headerEnd + 4 + contentLength)
+            break;
+    }
+
+    const auto text = request.toString();
+
+    if (headerEnd < 0 || !text.startsWith("POST ") || !text.upToFirstOccurrenceOf("\r\n", false, false).contains("/api/auth/serial"))
+    {
+        writeResponse(connection, 404, "Not Found", juce::var());
+        return;
+    }
+
+    if (delayMs > 0)
+        wait(delayMs);
+
+    const auto body = juce::JSON::parse(text.substring(headerEnd + 4));
+    const auto serialNumber = body.getProperty("serialNumber", {}).toString().trim();
+
+    if (serialNumber.isEmpty() || serialNumber.startsWithIgnoreCase("invalid"))
+    {
+        auto *error = new juce::DynamicObject();
+        error->setProperty("error", "Invalid serial number");
+        writeResponse(connection, 401, "Unauthorized", juce::var(error));
+        return;
+    }
+
+    LicenseToken::Claims claims;
+    claims.serialNumber = serialNumber;
+    claims.issuedMillis = juce::Time::currentTimeMillis();
+
+    auto *reply = new juce::DynamicObject();
+    reply->setProperty("token", LicenseToken::sign(claims, juce::RSAKey(developmentPrivateKey)));
+    writeResponse(connection, 200, "OK", juce::var(reply));
+}
+
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_DEBUG
+
+/**
+ * Local stand-in for the license server, for testing registration without
+ * the network. It answers the serial endpoint on 127.0.0.1 with a token
+ * signed by the development key, so a debug build (or one without a
+ * production key) accepts it offline.
+ *
+ * Started with `--license-stub [port] [--delay <ms>]`, then point the app at
+ * it with `--license-server http://127.0.0.1:<port>/api/auth/serial`. Serials
+ * starting with "invalid" are rejected with a 401, everything else gets a
+ * token. --delay holds each reply back to mimic a slow studio network.
+ *
+ * Debug builds only: it signs with the development key, which release
+ * builds neither trust nor contain.
+ */
+class LicenseStubServer : private juce::Thread
+{
+public:
+    LicenseStubServer(int portToListenOn, int replyDelayMs);
+    ~LicenseStubServer() override;
+
+    /** True if the command line asks for the stub server instead of the normal app */
+    static bool isRequested(const juce::String &commandLine);
+
+    /** Builds a stub server from the command line arguments */
+    static std::unique_ptr<LicenseStubServer> createFromCommandLine(const juce::String &commandLine);
+
+    static constexpr int defaultPort = 8765;
+
+private:
+    void run() override;
+
+    /** Reads one request and writes its reply */
+    void handleConnection(juce::StreamingSocket &connection);
+
+    const int port;
+    const int delayMs;
+    juce::StreamingSocket listener;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LicenseStubServer)
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include "LicenseToken.h"
+
+#if !defined(FADER_KEYS_LICENSE_PUBLIC_KEY) && !JUCE_DEBUG
+ #error "Release builds need the production license key: define FADER_KEYS_LICENSE_PUBLIC_KEY as \"exponent,modulus\" in hex"
+#endif
+
+namespace
+{
+    // Release builds get the production key from the build settings (FADER_KEYS_LICENSE_PUBLIC_KEY,
+    // "exponent,modulus" in hex). Debug builds without one use the 2048-bit development key the
+    // local stub server signs with, which only exists in debug builds
+#ifdef FADER_KEYS_LICENSE_PUBLIC_KEY
+    constexpr const char *publicKeyString = FADER_KEYS_LICENSE_PUBLIC_KEY;
+#else
+    constexpr const char *publicKeyString =
+        "10001,"
+        "b33d5fbb97366e933c9e424305dd3a7e4173e1ed7021bc42a6c5bb5c061e2204"
+        "1e7b195512e3394f9f1a0f1b8acb5ffff83f9a7dc3ef6ef1d028d9def43b2b6d"
+        "cb70691564756ae8bde9849631a427be6c103b13db8b5483b1222700b00e41f6"
+        "6c2b64d5a104f5f00806bc9b7ef7965ddc92e44887ea487948c1953f54d84273"
+        "ba415feece81b9e327552f9ecdcbf261adf82d0e71fc72757169ada4e4860e54"
+        "857eba1f9aa9f6c13912592ac3d7907b694d9836449351753318f8d237688ac9"
+        "581ab5a59f7a37d69b6f317bbe3876ba57ac4bd6bc45ec43f28c507d6abb766a"
+        "7d528f29a63938d033e376df7242ecac8005d8c84fa0f2c50be81689509621cb";
+#endif
+
+    // ASN.1 DigestInfo header for a SHA-256 hash (RFC 8017, section 9.2)
+    constexpr uint8_t sha256DigestInfo[] = { 0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+                                             0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20 };
+
+    /** Bytes in the key's modulus, read from its "exponent,modulus" form */
+    int getModulusSize(const juce::RSAKey &key)
+    {
+        juce::BigInteger modulus;
+        modulus.parseString(key.toString().fromFirstOccurrenceOf(",", false, false), 16);
+        return (modulus.getHighestBit() + 8) / 8;
+    }
+
+    /** The claims' SHA-256 in a PKCS #1 v1.5 signature block as long as the modulus:
+        00 01 FF .. FF 00, the DigestInfo header and the hash. Zero if the key is too small */
+    juce::BigInteger encodeClaims(const juce::String &claimsJson, int modulusSize)
+    {
+        const auto hash = juce::SHA256(claimsJson.toUTF8()).getRawData();
+        const int numPaddingBytes = modulusSize - 3 - (int)sizeof(sha256DigestInfo) - (int)hash.getSize();
+
+        if (numPaddingBytes < 8)
+            return {};
+
+        juce::MemoryBlock block((size_t)modulusSize, true);
+        auto *bytes = static_cast<uint8_t *>(block.getData());
+
+        bytes[1] = 0x01;
+        std::fill(bytes + 2, bytes + 2 + numPaddingBytes, (uint8_t)0xff);
+
+        auto *digestInfo = bytes + 3 + numPaddingBytes;
+        std::copy(std::begin(sha256DigestInfo), std::end(sha256DigestInfo), digestInfo);
+        std::memcpy(digestInfo + sizeof(sha256DigestInfo), hash.getData(), hash.getSize());
+
+        // The block is big-endian, BigInteger loads the least significant byte first
+        std::reverse(bytes, bytes + modulusSize);
+
+        juce::BigInteger value;
+        value.loadFromMemoryBlock(block);
+        return value;
+    }
+}
+
+const juce::RSAKey &LicenseToken::getPublicKey()
+{
+    static const juce::RSAKey publicKey(publicKeyString);
+    return publicKey;
+}
+
+std::optional<LicenseToken::Claims> LicenseToken::verify(const juce::String &token, const juce::RSAKey &publicKey)
+{
+    const auto encodedClaims = token.upToFirstOccurrenceOf(".", false, false);
+    const auto signatureHex = token.fromFirstOccurrenceOf(".", false, false);
+
+    if (encodedClaims.isEmpty() || signatureHex.isEmpty() || !publicKey.isValid())
+        return std::nullopt;
+
+    juce::MemoryOutputStream claimsJson;
+    if (!juce::Base64::convertFromBase64(claimsJson, encodedClaims))
+        return std::nullopt;
+
+    const int modulusSize = getModulusSize(publicKey);
+    const auto expected = encodeClaims(claimsJson.toString(), modulusSize);
+
+    juce::BigInteger signature;
+    signature.parseString(signatureHex, 16);
+
+    // A signature is never longer than the modulus, applyToValue would split it into blocks
+    if (expected.isZero() || signature.getHighestBit() >= modulusSize * 8)
+        return std::nullopt;
+
+    // The whole block has to match, padding and DigestInfo header included
+    publicKey.applyToValue(signature);
+
+    if (signature != expected)
+        return std::nullopt;
+
+    const auto parsed = juce::JSON::parse(claimsJson.toString());
+
+    Claims claims;
+    claims.serialNumber = parsed.getProperty("serial", {}).toString();
+    claims.issuedMillis = (juce::int64)parsed.getProperty("issued", 0);
+
+    if (claims.serialNumber.isEmpty())
+        return std::nullopt;
+
+    return claims;
+}
+
+juce::String LicenseToken::sign(const Claims &claims, const juce::RSAKey &privateKey)
+{
+    auto *object = new juce::DynamicObject();
+    object->setProperty("serial", claims.serialNumber);
+    object->setProperty("issued", claims.issuedMillis);
+
+    const auto claimsJson = juce::JSON::toString(juce::var(object), true);
+    const auto utf8 = claimsJson.toUTF8();
+
+    auto signature = encodeClaims(claimsJson, getModulusSize(privateKey));
+    if (signature.isZero())
+        return {};
+
+    privateKey.applyToValue(signature);
+
+    return juce::Base64::toBase64(utf8.getAddress(), utf8.sizeInBytes() - 1) + "." + signature.toString(16);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <optional>
+
+/**
+ * Signed offline license tokens. The license server answers a serial with a
+ * token that is checked here with the built-in public key, so startup can
+ * confirm a registration with no network I/O.
+ *
+ * A token is "<base64 claims JSON>.<hex signature>". The signature is the
+ * SHA-256 of the claims JSON in a PKCS #1 v1.5 block padded to the key's
+ * modulus size, raised to the server's private RSA exponent. Verifying
+ * checks the whole block, padding included.
+ */
+namespace LicenseToken
+{
+    struct Claims
+    {
+        juce::String serialNumber;
+        juce::int64 issuedMillis = 0; // juce::Time::currentTimeMillis() when the server issued it
+    };
+
+    /** The public key tokens are checked against */
+    const juce::RSAKey &getPublicKey();
+
+    /** The claims of a correctly signed token, or nothing. CPU only, safe on any thread */
+    std::optional<Claims> verify(const juce::String &token, const juce::RSAKey &publicKey = getPublicKey());
+
+    /** Signs claims into a token, for the license server and the local stub. Empty if the key is
+        too small for a padded SHA-256 block */
+    juce::String sign(const Claims &claims, const juce::RSAKey &privateKey);
+}
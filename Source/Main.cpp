@@ -7,61 +7,18 @@
 */
 
 #include <JuceHeader.h>
+#include "EngineBench.h"
 #include "FaderEngine.h"
 #include "GlobalKeyListener.h"
+#include "LatencyProbe.h"
+#if JUCE_DEBUG
+ #include "LicenseStubServer.h"
+#endif
+#include "TraceReplay.h"
 #include "TrayIconMac.h"
 #include "RegistrationManager.h"
 #include "RegistrationDialog.h"
 
-//==============================================================================
-// Simple registration component
-class RegistrationComponent : public juce::Component
-{
-public:
-    RegistrationComponent(std::function<bool(const juce::String&)> registrationFunc)
-        : onRegister(registrationFunc)
-    {
-        serialNumberInput.setTextToShowWhenEmpty("Enter Serial Number", juce::Colours::grey);
-        addAndMakeVisible(serialNumberInput);
-
-        registerButton.setButtonText("Register");
-        registerButton.onClick = [this] { attemptRegistration(); };
-        addAndMakeVisible(registerButton);
-
-        setSize(300, 100);
-    }
-
-private:
-    void attemptRegistration()
-    {
-        if (onRegister(serialNumberInput.getText()))
-        {
-            // If registration is successful, close the window
-            if (auto* dw = findParentComponentOfClass<juce::DialogWindow>())
-                dw->exitModalState(1);  // 1 indicates success
-        }
-        else
-        {
-            juce::AlertWindow::showMessageBoxAsync(
-                juce::MessageBoxIconType::WarningIcon,
-                "Invalid Serial Number",
-                "Please enter a valid serial number.");
-        }
-    }
-
-    void resized() override
-    {
-        auto bounds = getLocalBounds().reduced(10);
-        serialNumberInput.setBounds(bounds.removeFromTop(30));
-        bounds.removeFromTop(10);
-        registerButton.setBounds(bounds.removeFromTop(30));
-    }
-
-    std::function<bool(const juce::String&)> onRegister;
-    juce::TextEditor serialNumberInput;
-    juce::TextButton registerButton;
-};
-
 //==============================================================================
 // Main application class
 class FaderKeysApplication : public juce::JUCEApplication
@@ -81,26 +38,67 @@ public:
     bool moreThanOneInstanceAllowed() override            { return true; }
 
     //==============================================================================
-    void initialise(const juce::String&) override
+    void initialise(const juce::String& commandLine) override
     {
+        // Headless latency check against a fake DAW, no tray icon or key listener
+        if (LatencyProbe::isRequested(commandLine))
+        {
+            faderEngine = std::make_unique<FaderEngine>();
+            latencyProbe = LatencyProbe::createFromCommandLine(*faderEngine, commandLine);
+            return;
+        }
+
+        // Headless replay of a recorded trace
+        if (TraceReplay::isRequested(commandLine))
+        {
+            faderEngine = std::make_unique<FaderEngine>();
+            traceReplay = TraceReplay::createFromCommandLine(*faderEngine, commandLine);
+            return;
+        }
+
+        // Headless engine benchmark and fuzzer, every surface so all of them get exercised
+        if (EngineBench::isRequested(commandLine))
+        {
+            faderEngine = std::make_unique<FaderEngine>(FaderEngine::maxSurfaces);
+            engineBench = EngineBench::createFromCommandLine(*faderEngine, commandLine);
+            return;
+        }
+
+#if JUCE_DEBUG
+        // Headless license server stand-in, for testing registration offline (debug builds only)
+        if (LicenseStubServer::isRequested(commandLine))
+        {
+            licenseStub = LicenseStubServer::createFromCommandLine(commandLine);
+            return;
+        }
+
+        // --license-server <url> sends registration requests somewhere else, e.g. the stub
+        const auto args = getCommandLineParameterArray();
+        const int serverIndex = args.indexOf("--license-server");
+        if (serverIndex >= 0)
+            registrationManager->setServerUrl(juce::URL(args[serverIndex + 1]));
+#endif
+
+#if JUCE_MAC
         // Create tray icon first, but with engine disabled
         TrayIconMac::createStatusBarIcon(nullptr, false);
+#endif
 
         if (!registrationManager->isRegistered())
         {
             RegistrationDialog::show(
-                [this](const juce::String& serial, std::function<void(bool)> callback)
+                [this](const juce::String& serial, std::function<void(RegistrationManager::Result)> callback)
                 {
                     registrationManager->registerSerialNumberAsync(serial,
-                        [this, callback](bool success)
+                        [this, callback](RegistrationManager::Result result)
                         {
-                            if (success)
+                            if (result == RegistrationManager::Result::Registered)
                             {
                                 showRegistrationSuccessMessage();
                                 // Don't call finishStartup() here
                             }
                             if (callback)
-                                callback(success);
+                                callback(result);
                         });
                 });
             return;
@@ -111,19 +109,40 @@ public:
 
     void shutdown() override
     {
-        // Save sensitivity settings before cleanup
-        if (faderEngine != nullptr)
+        // Save sensitivity settings before cleanup, probe and replay runs leave them alone
+        if (faderEngine != nullptr && latencyProbe == nullptr && traceReplay == nullptr && engineBench == nullptr)
         {
             auto* settings = appProperties->getUserSettings();
             settings->setValue("nudgeSensitivity", (int)faderEngine->getNudgeSensitivity());
+            settings->setValue("numSurfaces", faderEngine->getNumSurfaces());
+            settings->setValue("midi2Output", faderEngine->isMidi2Enabled());
+            settings->setValue("maxMoveRateHz", faderEngine->getMaxMoveRateHz());
+            settings->setValue("recallPacingMs", faderEngine->getRecallPacingMs());
+            settings->setValue("rampPointRateHz", faderEngine->getRampPointRateHz());
+            settings->setValue("holdToTouch", faderEngine->isHoldToTouchEnabled());
+            settings->setValue("faderGroup", FaderEngine::formatFaderGroup(faderEngine->getFaderGroup()));
+            settings->setValue("groupFaders", faderEngine->isGroupEnabled());
+            settings->setValue("accelerationCurve", (int)faderEngine->getAccelerationCurve());
+            settings->setValue("recordStats", faderEngine->isRecordingStats());
             settings->saveIfNeeded();
         }
 
         // Ensure proper cleanup order
+#if JUCE_MAC
         // Remove the tray icon
         TrayIconMac::removeStatusBarIcon();
+#endif
         // Stop the global key listener
         stopGlobalKeyListener();
+        // Don't wait on the license server while quitting
+        registrationManager->cancelPendingRequest();
+        // Stop the probe, replay or bench before the engine it drives
+        latencyProbe.reset();
+        traceReplay.reset();
+        engineBench.reset();
+#if JUCE_DEBUG
+        licenseStub.reset();
+#endif
         // Reset the FaderEngine
         faderEngine.reset();
 
@@ -152,40 +171,6 @@ public:
         return *appProperties;
     }
 
-    bool isRegistered() const
-    {
-        auto* settings = appProperties->getUserSettings();
-        bool registered = settings->getBoolValue("isRegistered", false);
-        return registered;
-    }
-
-    bool registerSerialNumber(const juce::String& serialNumber)
-    {
-        // Validate the serial number via HTTP
-        const bool isValid = validateSerialNumber(serialNumber);
-        if (isValid)
-        {
-            auto* settings = appProperties->getUserSettings();
-            settings->setValue("isRegistered", true);
-            settings->setValue("serialNumber", serialNumber);
-            settings->saveIfNeeded();
-
-            // Show success message and quit
-            juce::AlertWindow::showMessageBoxAsync(
-                juce::MessageBoxIconType::InfoIcon,
-                "Registration Successful",
-                "Please relaunch Fader Keys to complete setup.",
-                "OK",
-                nullptr,
-                juce::ModalCallbackFunction::create([](int) {
-                    juce::Timer::callAfterDelay(500, []() {
-                        juce::JUCEApplication::getInstance()->systemRequestedQuit();
-                    });
-                }));
-        }
-        return isValid;
-    }
-
 private:
     // Setup the property file location
     juce::PropertiesFile::Options getPropertyFileOptions()
@@ -199,43 +184,6 @@ private:
         return options;
     }
 
-    bool validateSerialNumber(const juce::String& serialNumber)
-    {
-        // Create URL object for the authentication endpoint
-        juce::URL url("https://www.faderkeys.com/api/auth/serial");
-
-        // Create the JSON request body
-        juce::var jsonBody = juce::var(new juce::DynamicObject());
-        jsonBody.getDynamicObject()->setProperty("serialNumber", serialNumber);
-
-        const juce::String jsonString = juce::JSON::toString(jsonBody);
-
-        // Set up request headers
-        juce::URL::InputStreamOptions opts(juce::URL::ParameterHandling::inPostData);
-        auto newOpts = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inPostData)
-                          .withExtraHeaders("Content-Type: application/json")
-                          .withConnectionTimeoutMs(5000);
-
-        // Attach the JSON payload as the POST data
-        url = url.withPOSTData(jsonString);
-
-        // Store the return value of createInputStream
-        auto inputStream = url.createInputStream(newOpts);
-        if (inputStream != nullptr)
-        {
-            const juce::String response = inputStream->readEntireStreamAsString();
-            auto parsed = juce::JSON::parse(response);
-
-            if (auto* webStream = dynamic_cast<juce::WebInputStream*>(inputStream.get()))
-            {
-                const int statusCode = webStream->getStatusCode();
-                // If 200, success; if 401 (or anything else), fail
-                return statusCode == 200;
-            }
-        }
-        return false;
-    }
-
     void finishStartup()
     {
         auto* settings = getAppProperties().getUserSettings();
@@ -244,17 +192,42 @@ private:
                                   static_cast<int>(FaderEngine::NudgeSensitivity::Medium)));
 
         // Create FaderEngine first
-        faderEngine = std::make_unique<FaderEngine>();
+        faderEngine = std::make_unique<FaderEngine>(settings->getIntValue("numSurfaces", 1),
+                                                    settings->getBoolValue("midi2Output", false));
         faderEngine->setNudgeSensitivity(lastSensitivity);
+        faderEngine->setMaxMoveRateHz(settings->getIntValue("maxMoveRateHz", faderEngine->getMaxMoveRateHz()));
+        faderEngine->setRecallPacingMs(settings->getIntValue("recallPacingMs", faderEngine->getRecallPacingMs()));
+        faderEngine->setRampPointRateHz(settings->getIntValue("rampPointRateHz", faderEngine->getRampPointRateHz()));
+        faderEngine->setHoldToTouchEnabled(settings->getBoolValue("holdToTouch", faderEngine->isHoldToTouchEnabled()));
+        faderEngine->setFaderGroup(FaderEngine::parseFaderGroup(settings->getValue("faderGroup")));
+        faderEngine->setGroupEnabled(settings->getBoolValue("groupFaders", faderEngine->isGroupEnabled()));
+        faderEngine->setAccelerationCurve(static_cast<MotionCurve::Shape>(
+            settings->getIntValue("accelerationCurve", static_cast<int>(faderEngine->getAccelerationCurve()))));
+        faderEngine->setStatsFile(settings->getFile().getSiblingFile("stats.txt"));
+        faderEngine->setRecordingStats(settings->getBoolValue("recordStats", false));
+
+        // --record-trace <file> records the session for replay
+        const auto args = getCommandLineParameterArray();
+        const int traceIndex = args.indexOf("--record-trace");
+        if (traceIndex >= 0)
+            faderEngine->getTraceRecorder().start(juce::File::getCurrentWorkingDirectory().getChildFile(args[traceIndex + 1]));
+
+        // Profiles must be loaded before the key listener resolves the focused app
+        faderEngine->getDawProfiles().loadFromFile(settings->getFile().getSiblingFile("daw-profiles.json"));
+        faderEngine->getSnapshots().loadFromFile(settings->getFile().getSiblingFile("snapshots.json"));
 
         // Start key listener before creating tray icon
         startGlobalKeyListener(faderEngine.get());
 
+        // Registrations from before license tokens pick one up in the background
+        registrationManager->refreshLegacyRegistrationAsync();
 
+#if JUCE_MAC
         // Remove the old tray icon and create new one with engine enabled
         TrayIconMac::removeStatusBarIcon();
         TrayIconMac::createStatusBarIcon(faderEngine.get(), true);
         TrayIconMac::updateSensitivityMenu(lastSensitivity);
+#endif
 
 
     }
@@ -275,6 +248,12 @@ private:
     }
 
     std::unique_ptr<FaderEngine>                faderEngine;
+    std::unique_ptr<LatencyProbe>               latencyProbe;
+    std::unique_ptr<TraceReplay>                traceReplay;
+    std::unique_ptr<EngineBench>                engineBench;
+#if JUCE_DEBUG
+    std::unique_ptr<LicenseStubServer>          licenseStub;
+#endif
     std::unique_ptr<juce::ApplicationProperties> appProperties;
     std::unique_ptr<RegistrationManager> registrationManager;
     juce::DialogWindow* activeDialog = nullptr;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "FaderState.h"
+
+/**
+ * Per-channel meter peaks for one surface, from the levels the DAW streams
+ * to it: HUI polyphonic aftertouch or MCU channel pressure, both 0-12.
+ *
+ * The MIDI input thread raises each channel's peak with a single atomic
+ * update, no locks and no allocation. The UI samples at its own rate and
+ * takes the highest level since its last sample, so short peaks between
+ * samples still show.
+ */
+class MeterLevels
+{
+public:
+    static constexpr int numChannels = FaderState::numFaders;
+
+    // 0x0C on both HUI and MCU meters
+    static constexpr int maxLevel = 12;
+
+    /** Raises a channel's peak (MIDI input thread) */
+    void setLevel(int channelIndex, int level)
+    {
+        if (channelIndex < 0 || channelIndex >= numChannels)
+            return;
+
+        // Stored as level + 1, so 0 means nothing arrived since the last sample
+        const auto stored = (uint8_t)(juce::jlimit(0, maxLevel, level) + 1);
+        auto &peak = peaks[(size_t)channelIndex];
+        auto held = peak.load(std::memory_order_relaxed);
+
+        // The only other writer is takePeak resetting to 0, so this settles at once
+        while (stored > held && !peak.compare_exchange_weak(held, stored, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /** The highest level since the last call, or -1 if the DAW sent none. Call from one reader thread */
+    int takePeak(int channelIndex)
+    {
+        if (channelIndex < 0 || channelIndex >= numChannels)
+            return -1;
+
+        return (int)peaks[(size_t)channelIndex].exchange(0, std::memory_order_relaxed) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint8_t>, numChannels> peaks{};
+};
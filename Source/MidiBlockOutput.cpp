@@ -0,0 +1,39 @@
+#include "MidiBlockOutput.h"
+#include "MidiEncoding.h"
+
+#if !JUCE_MAC
+
+namespace
+{
+    // No multi-message packets through JUCE's ports, so a block is sent one message at a time
+    class JuceMidiBlockOutput : public MidiBlockOutput
+    {
+    public:
+        explicit JuceMidiBlockOutput(std::unique_ptr<juce::MidiOutput> outputToUse) : output(std::move(outputToUse)) {}
+
+        void send(const uint8_t *bytes, int numBytes) override
+        {
+            // The engine thread flushes here while the MIDI input thread answers pings, and JUCE's
+            // ALSA output isn't safe to share. Holding the lock for the whole block also keeps a
+            // ping reply from landing in the middle of a HUI burst
+            const juce::ScopedLock sl(sendLock);
+
+            for (int i = 0; i + (int)MidiEncoding::messageSize <= numBytes; i += (int)MidiEncoding::messageSize)
+                output->sendMessageNow(juce::MidiMessage(bytes[i], bytes[i + 1], bytes[i + 2]));
+        }
+
+    private:
+        std::unique_ptr<juce::MidiOutput> output;
+        juce::CriticalSection sendLock;
+    };
+}
+
+std::unique_ptr<MidiBlockOutput> MidiBlockOutput::create(const juce::String &name)
+{
+    if (auto output = juce::MidiOutput::createNewDevice(name))
+        return std::make_unique<JuceMidiBlockOutput>(std::move(output));
+
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+
+/**
+ * A surface's virtual MIDI 1.0 output port that takes a block of whole
+ * messages at once. JUCE's MidiOutput::sendBlockOfMessagesNow is a loop of
+ * sendMessageNow, one OS send per message, so each platform provides its
+ * own: on macOS (MidiBlockOutputMac.mm) a block is one CoreMIDI packet sent
+ * with a single MIDIReceived, so grouped faders land in the DAW together.
+ * Elsewhere the block goes through a JUCE MidiOutput one message at a time.
+ */
+class MidiBlockOutput
+{
+public:
+    virtual ~MidiBlockOutput() = default;
+
+    /** Sends complete 3-byte channel messages back to back, all with the same timestamp.
+        Safe to call from any thread */
+    virtual void send(const uint8_t *bytes, int numBytes) = 0;
+
+    /** Creates the virtual output port, or returns nullptr if it couldn't be created */
+    static std::unique_ptr<MidiBlockOutput> create(const juce::String &name);
+};
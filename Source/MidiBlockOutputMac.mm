@@ -0,0 +1,81 @@
+#if JUCE_MAC
+
+#include "MidiBlockOutput.h"
+
+#import <CoreMIDI/CoreMIDI.h>
+#import <Foundation/Foundation.h>
+#include <array>
+
+namespace
+{
+    // Room for a surface's largest block (FaderSurface::outputBufferBytes) plus the packet header, kept on the stack
+    constexpr size_t packetListBytes = 1024 + 64;
+
+    // Built the way JUCE IDs its virtual outputs (bundle ID, name, direction), so DAWs that
+    // remember ports by ID still find the port they were set up with
+    SInt32 getUniqueId(const juce::String &name)
+    {
+        juce::String id;
+        if (auto *bundleId = [[NSBundle mainBundle] bundleIdentifier])
+            id = juce::String([bundleId UTF8String]);
+
+        return (SInt32)(id + "." + name + ".output").hashCode();
+    }
+
+    class MidiBlockOutputMac : public MidiBlockOutput
+    {
+    public:
+        ~MidiBlockOutputMac() override
+        {
+            if (source != 0)
+                MIDIEndpointDispose(source);
+            if (client != 0)
+                MIDIClientDispose(client);
+        }
+
+        bool open(const juce::String &name)
+        {
+            if (MIDIClientCreate(CFSTR("Fader Keys MIDI"), nullptr, nullptr, &client) != noErr)
+                return false;
+
+            const auto cfName = name.toCFString();
+            const auto status = MIDISourceCreate(client, cfName, &source);
+            CFRelease(cfName);
+
+            if (status != noErr)
+                return false;
+
+            MIDIObjectSetIntegerProperty(source, kMIDIPropertyUniqueID, getUniqueId(name));
+            return true;
+        }
+
+        void send(const uint8_t *bytes, int numBytes) override
+        {
+            // The whole block is one packet with one timestamp (0 = now), so the DAW reads it in one go
+            alignas(MIDIPacketList) std::array<Byte, packetListBytes> storage;
+            auto *packetList = reinterpret_cast<MIDIPacketList *>(storage.data());
+            auto *packet = MIDIPacketListInit(packetList);
+
+            packet = MIDIPacketListAdd(packetList, storage.size(), packet, 0, (ByteCount)numBytes, bytes);
+            jassert(packet != nullptr);
+
+            if (packet != nullptr)
+                MIDIReceived(source, packetList);
+        }
+
+    private:
+        MIDIClientRef client = 0;
+        MIDIEndpointRef source = 0;
+    };
+}
+
+std::unique_ptr<MidiBlockOutput> MidiBlockOutput::create(const juce::String &name)
+{
+    auto output = std::make_unique<MidiBlockOutputMac>();
+    if (output->open(name))
+        return output;
+
+    return nullptr;
+}
+
+#endif
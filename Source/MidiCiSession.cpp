@@ -0,0 +1,163 @@
+#include "MidiCiSession.h"
+#include "UmpEncoding.h"
+
+namespace
+{
+    // Discovery is broadcast this often until a host answers
+    constexpr int discoveryIntervalMs = 3000;
+
+    // Developer/non-commercial manufacturer ID, Fader Keys family and model 1
+    const juce::midi_ci::DeviceInfo deviceInfo{
+        {std::byte{0x7D}, std::byte{0x00}, std::byte{0x00}},
+        {std::byte{0x46}, std::byte{0x4B}},
+        {std::byte{0x01}, std::byte{0x00}},
+        {std::byte{0x00}, std::byte{0x03}, std::byte{0x00}, std::byte{0x00}}};
+
+    // Sysex7 data bytes by position in a packet: word 0 bytes 2-3, word 1 bytes 0-3
+    uint8_t getSysex7Byte(const uint32_t *words, int index)
+    {
+        const auto word = index < 2 ? words[0] : words[1];
+        const int shift = index < 2 ? 8 * (1 - index) : 8 * (5 - index);
+        return static_cast<uint8_t>((word >> shift) & 0x7F);
+    }
+}
+
+// CONSTRUCTOR / DESTRUCTOR
+//==============================================================================
+MidiCiSession::MidiCiSession(UmpPort &portToUse)
+    : port(portToUse)
+{
+    const auto options = juce::midi_ci::DeviceOptions()
+                             .withDeviceInfo(deviceInfo)
+                             .withOutputs({this})
+                             .withMaxSysExSize((size_t)maxMessageSize);
+
+    device = std::make_unique<juce::midi_ci::Device>(options);
+    device->addListener(*this);
+
+    timerCallback();
+    startTimer(discoveryIntervalMs);
+}
+
+MidiCiSession::~MidiCiSession()
+{
+    stopTimer();
+    cancelPendingUpdate();
+    device->removeListener(*this);
+}
+
+// INCOMING (MIDI INPUT THREAD)
+//==============================================================================
+void MidiCiSession::handleSysex7Packet(const uint32_t *words)
+{
+    const auto status = static_cast<uint8_t>((words[0] >> 20) & 0x0F);
+    const int numBytes = juce::jmin((int)UmpEncoding::sysex7BytesPerPacket, (int)((words[0] >> 16) & 0x0F));
+
+    if (status == UmpEncoding::sysex7Complete || status == UmpEncoding::sysex7Start)
+    {
+        inMessage = true;
+        overflowed = false;
+        incoming.size = 0;
+    }
+    else if (!inMessage)
+    {
+        // Continuation of a message we never saw start
+        return;
+    }
+
+    for (int i = 0; i < numBytes; ++i)
+    {
+        if (incoming.size < maxMessageSize)
+            incoming.data[(size_t)incoming.size++] = getSysex7Byte(words, i);
+        else
+            overflowed = true;
+    }
+
+    if (status != UmpEncoding::sysex7Complete && status != UmpEncoding::sysex7End)
+        return;
+
+    inMessage = false;
+
+    // Truncated messages and anything that isn't a universal sysex (MIDI-CI) are dropped here
+    if (overflowed || incoming.size == 0 || incoming.data[0] != 0x7E)
+        return;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(mailboxLock);
+
+        if (numWaiting == mailboxSize)
+            return;
+
+        mailbox[(size_t)numWaiting++] = incoming;
+    }
+
+    triggerAsyncUpdate();
+}
+
+// MESSAGE THREAD
+//==============================================================================
+void MidiCiSession::handleAsyncUpdate()
+{
+    std::array<Message, mailboxSize> messages;
+    int numMessages = 0;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(mailboxLock);
+
+        for (int i = 0; i < numWaiting; ++i)
+            messages[(size_t)i] = mailbox[(size_t)i];
+
+        numMessages = numWaiting;
+        numWaiting = 0;
+    }
+
+    for (int i = 0; i < numMessages; ++i)
+    {
+        const auto &message = messages[(size_t)i];
+        device->processMessage({UmpEncoding::group,
+                                juce::Span<const std::byte>(reinterpret_cast<const std::byte *>(message.data.data()),
+                                                            (size_t)message.size)});
+    }
+}
+
+void MidiCiSession::processMessage(juce::universal_midi_packets::BytesOnGroup message)
+{
+    // A whole MIDI-CI message goes out in one send
+    std::array<uint32_t, 2 * (maxMessageSize / UmpEncoding::sysex7BytesPerPacket + 1)> words;
+    int numWords = 0;
+
+    UmpEncoding::forEachSysex7Packet(reinterpret_cast<const uint8_t *>(message.bytes.data()), message.bytes.size(),
+                                     [&](const uint32_t *packet, int packetWords)
+                                     {
+                                         if (numWords + packetWords > (int)words.size())
+                                             return;
+
+                                         std::copy(packet, packet + packetWords, words.begin() + numWords);
+                                         numWords += packetWords;
+                                     });
+
+    if (numWords > 0)
+        port.send(words.data(), numWords);
+}
+
+void MidiCiSession::deviceAdded(juce::midi_ci::MUID)
+{
+    // Only a MIDI 2.0 host answers discovery on this port, so from here on it gets MIDI 2.0 packets
+    peerConnected.store(true, std::memory_order_release);
+    stopTimer();
+}
+
+void MidiCiSession::deviceRemoved(juce::midi_ci::MUID)
+{
+    // The host closed or invalidated its MUID, fall back to MIDI 1.0 and look for it again
+    if (device->getDiscoveredMuids().empty())
+    {
+        peerConnected.store(false, std::memory_order_release);
+        startTimer(discoveryIntervalMs);
+    }
+}
+
+void MidiCiSession::timerCallback()
+{
+    device->sendDiscovery();
+}
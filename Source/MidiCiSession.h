@@ -0,0 +1,73 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "UmpPort.h"
+
+/**
+ * MIDI-CI discovery on a surface's MIDI 2.0 port, through juce_midi_ci.
+ * Discovery is broadcast until a host answers; once one does, the surface
+ * sends its MCU messages as MIDI 2.0 packets. If no host answers, or the
+ * host invalidates its MUID, the surface stays on (or goes back to) the
+ * MIDI 1.0 encoders.
+ *
+ * The juce_midi_ci device lives on the message thread. Incoming sysex7
+ * packets are reassembled on the MIDI input thread and handed over through
+ * a small preallocated mailbox.
+ */
+class MidiCiSession : private juce::midi_ci::DeviceMessageHandler,
+                      private juce::midi_ci::DeviceListener,
+                      private juce::Timer,
+                      private juce::AsyncUpdater
+{
+public:
+    explicit MidiCiSession(UmpPort &portToUse);
+    ~MidiCiSession() override;
+
+    /** True while a MIDI-CI host is connected on the MIDI 2.0 port. Safe to call from any thread */
+    bool isPeerConnected() const { return peerConnected.load(std::memory_order_acquire); }
+
+    /** Collects one sysex7 packet of a MIDI-CI message (MIDI input thread only) */
+    void handleSysex7Packet(const uint32_t *words);
+
+    // Largest MIDI-CI message accepted or sent, without F0/F7
+    static constexpr int maxMessageSize = 512;
+
+private:
+    // Outgoing MIDI-CI messages from the device (message thread)
+    void processMessage(juce::universal_midi_packets::BytesOnGroup message) override;
+
+    // Discovered hosts (message thread)
+    void deviceAdded(juce::midi_ci::MUID muid) override;
+    void deviceRemoved(juce::midi_ci::MUID muid) override;
+
+    /** Rebroadcasts discovery until a host answers */
+    void timerCallback() override;
+
+    /** Feeds reassembled messages to the device */
+    void handleAsyncUpdate() override;
+
+    UmpPort &port;
+    std::unique_ptr<juce::midi_ci::Device> device;
+    std::atomic<bool> peerConnected{false};
+
+    struct Message
+    {
+        int size = 0;
+        std::array<uint8_t, maxMessageSize> data{};
+    };
+
+    // Message being reassembled (MIDI input thread only)
+    Message incoming;
+    bool inMessage = false;
+    bool overflowed = false;
+
+    // Complete messages waiting for the message thread
+    static constexpr int mailboxSize = 4;
+    juce::SpinLock mailboxLock;
+    std::array<Message, mailboxSize> mailbox;
+    int numWaiting = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiCiSession)
+};
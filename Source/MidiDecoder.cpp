@@ -0,0 +1,315 @@
+#include "MidiDecoder.h"
+
+namespace
+{
+    enum class StatusKind : uint8_t
+    {
+        Data,           // 0x00-0x7F, not a status byte
+        NoteOff,
+        NoteOn,
+        PolyPressure,
+        Controller,
+        ProgramChange,
+        ChannelPressure,
+        PitchWheel,
+        SysExStart,
+        SysExEnd,
+        SystemCommon,
+        RealTime
+    };
+
+    struct StatusEntry
+    {
+        StatusKind kind;
+        uint8_t dataBytes;
+    };
+
+    constexpr StatusEntry makeStatusEntry(int status)
+    {
+        if (status < 0x80)
+            return {StatusKind::Data, 0};
+
+        switch (status & 0xF0)
+        {
+        case 0x80: return {StatusKind::NoteOff, 2};
+        case 0x90: return {StatusKind::NoteOn, 2};
+        case 0xA0: return {StatusKind::PolyPressure, 2};
+        case 0xB0: return {StatusKind::Controller, 2};
+        case 0xC0: return {StatusKind::ProgramChange, 1};
+        case 0xD0: return {StatusKind::ChannelPressure, 1};
+        case 0xE0: return {StatusKind::PitchWheel, 2};
+        default: break;
+        }
+
+        switch (status)
+        {
+        case 0xF0: return {StatusKind::SysExStart, 0};
+        case 0xF7: return {StatusKind::SysExEnd, 0};
+        case 0xF1: return {StatusKind::SystemCommon, 1}; // MTC quarter frame
+        case 0xF2: return {StatusKind::SystemCommon, 2}; // Song position
+        case 0xF3: return {StatusKind::SystemCommon, 1}; // Song select
+        case 0xF4:
+        case 0xF5:
+        case 0xF6: return {StatusKind::SystemCommon, 0};
+        default: return {StatusKind::RealTime, 0};       // 0xF8-0xFF
+        }
+    }
+
+    constexpr std::array<StatusEntry, 256> makeStatusTable()
+    {
+        std::array<StatusEntry, 256> table{};
+        for (int i = 0; i < 256; ++i)
+            table[(size_t)i] = makeStatusEntry(i);
+        return table;
+    }
+
+    constexpr auto STATUS_TABLE = makeStatusTable();
+
+    //==============================================================================
+    enum class ControllerKind : uint8_t
+    {
+        None,
+        HuiFaderMsb,
+        HuiFaderLsb,
+        HuiZoneLed
+    };
+
+    struct ControllerEntry
+    {
+        ControllerKind kind;
+        uint8_t faderIndex;
+    };
+
+    // What each controller number means on channel 1
+    constexpr std::array<ControllerEntry, 128> makeControllerTable()
+    {
+        std::array<ControllerEntry, 128> table{};
+
+        for (uint8_t i = 0; i < 8; ++i)
+        {
+            table[i] = {ControllerKind::HuiFaderMsb, i};        // CC 0-7
+            table[0x20 + i] = {ControllerKind::HuiFaderLsb, i}; // CC 32-39
+        }
+
+        // HUI zone select and port LED state
+        table[0x0C] = {ControllerKind::HuiZoneLed, 0};
+        table[0x2C] = {ControllerKind::HuiZoneLed, 0};
+
+        return table;
+    }
+
+    constexpr auto CONTROLLER_TABLE = makeControllerTable();
+
+    // Meter levels go up to 0x0C, MCU uses 0x0E/0x0F to set and clear the overload light
+    constexpr uint8_t maxMeterLevel = 0x0C;
+
+    // Mackie sysex header (F0 00 00 66 <model>), HUI is model 05, MCU main/extender are 14/15
+    constexpr uint8_t mackieManufacturerId[] = {0x00, 0x00, 0x66};
+    constexpr uint8_t huiModelId = 0x05;
+    constexpr uint8_t mcuModelId = 0x14;
+    constexpr uint8_t mcuExtenderModelId = 0x15;
+}
+
+// DECODING
+//==============================================================================
+void MidiDecoder::feed(const uint8_t *data, int size)
+{
+    for (int i = 0; i < size; ++i)
+    {
+        const uint8_t byte = data[i];
+        const auto &entry = STATUS_TABLE[byte];
+
+        // Real-time bytes can appear anywhere, even inside other messages
+        if (entry.kind == StatusKind::RealTime)
+            continue;
+
+        if (inSysEx)
+        {
+            if (entry.kind == StatusKind::Data)
+            {
+                if (sysExSize < maxSysExSize)
+                    sysExBuffer[(size_t)sysExSize++] = byte;
+                else
+                    sysExOverflowed = true;
+                continue;
+            }
+
+            inSysEx = false;
+
+            if (entry.kind == StatusKind::SysExEnd)
+            {
+                if (sysExSize < maxSysExSize)
+                    sysExBuffer[(size_t)sysExSize++] = byte;
+                else
+                    sysExOverflowed = true;
+
+                dispatchSysEx();
+                continue;
+            }
+
+            // Any other status byte ends an unterminated sysex, which is dropped
+        }
+
+        switch (entry.kind)
+        {
+        case StatusKind::Data:
+            // Data byte with no status to apply it to
+            if (status == 0)
+                break;
+
+            dataBytes[(size_t)numDataBytes++] = byte;
+
+            if (numDataBytes == dataBytesNeeded)
+            {
+                dispatchChannelMessage(status, dataBytes[0], dataBytes[1]);
+                numDataBytes = 0;
+
+                // System common messages don't set running status
+                if (status >= 0xF0)
+                    status = 0;
+            }
+            break;
+
+        case StatusKind::SysExStart:
+            inSysEx = true;
+            sysExOverflowed = false;
+            sysExSize = 0;
+            sysExBuffer[(size_t)sysExSize++] = byte;
+            status = 0;
+            break;
+
+        case StatusKind::SysExEnd:
+            // Stray end of sysex
+            status = 0;
+            break;
+
+        case StatusKind::SystemCommon:
+            status = entry.dataBytes > 0 ? byte : 0;
+            dataBytesNeeded = entry.dataBytes;
+            numDataBytes = 0;
+            break;
+
+        case StatusKind::NoteOff:
+        case StatusKind::NoteOn:
+        case StatusKind::PolyPressure:
+        case StatusKind::Controller:
+        case StatusKind::ProgramChange:
+        case StatusKind::ChannelPressure:
+        case StatusKind::PitchWheel:
+        case StatusKind::RealTime:
+        default:
+            status = byte;
+            dataBytesNeeded = entry.dataBytes;
+            numDataBytes = 0;
+            dataBytes[1] = 0;
+            break;
+        }
+    }
+}
+
+void MidiDecoder::reset()
+{
+    status = 0;
+    dataBytesNeeded = 0;
+    numDataBytes = 0;
+    inSysEx = false;
+    sysExOverflowed = false;
+    sysExSize = 0;
+}
+
+// DISPATCH
+//==============================================================================
+void MidiDecoder::dispatchChannelMessage(uint8_t statusByte, uint8_t data1, uint8_t data2)
+{
+    const int channelIndex = statusByte & 0x0F;
+
+    switch (STATUS_TABLE[statusByte].kind)
+    {
+    case StatusKind::NoteOn:
+    case StatusKind::NoteOff:
+        // Pro Tools's ping. The same bytes turn off REC ARM 1's LED on MCU, so the
+        // handler decides whether it counts as HUI evidence
+        if (channelIndex == 0 && data1 == 0 && data2 == 0)
+            handler.huiPing();
+        break;
+
+    case StatusKind::Controller:
+    {
+        if (channelIndex != 0)
+            break;
+
+        const auto &controller = CONTROLLER_TABLE[data1];
+        switch (controller.kind)
+        {
+        case ControllerKind::HuiFaderMsb:
+        case ControllerKind::HuiFaderLsb:
+            handler.protocolEvidence(ControlProtocol::Hui);
+            handler.huiFaderByte(controller.faderIndex, controller.kind == ControllerKind::HuiFaderMsb, data2);
+            break;
+        case ControllerKind::HuiZoneLed:
+            handler.protocolEvidence(ControlProtocol::Hui);
+            break;
+        case ControllerKind::None:
+        default:
+            break;
+        }
+        break;
+    }
+
+    case StatusKind::PitchWheel:
+        handler.protocolEvidence(ControlProtocol::Mcu);
+        handler.pitchWheel(channelIndex, data1 | (data2 << 7));
+        break;
+
+    case StatusKind::PolyPressure:
+        // HUI meters: A0 <channel 0-7> <side (0 left, 1 right) << 4 | level>, both sides share a peak
+        if (channelIndex == 0 && data1 < 8)
+        {
+            handler.protocolEvidence(ControlProtocol::Hui);
+
+            if ((data2 & 0x0F) <= maxMeterLevel)
+                handler.meterLevel(data1, data2 & 0x0F);
+        }
+        break;
+
+    case StatusKind::ChannelPressure:
+        // MCU meters: D0 <channel 0-7 << 4 | level>
+        if (channelIndex == 0)
+        {
+            handler.protocolEvidence(ControlProtocol::Mcu);
+
+            if ((data1 & 0x0F) <= maxMeterLevel)
+                handler.meterLevel(data1 >> 4, data1 & 0x0F);
+        }
+        break;
+
+    case StatusKind::Data:
+    case StatusKind::ProgramChange:
+    case StatusKind::SysExStart:
+    case StatusKind::SysExEnd:
+    case StatusKind::SystemCommon:
+    case StatusKind::RealTime:
+    default:
+        break;
+    }
+}
+
+void MidiDecoder::dispatchSysEx()
+{
+    // Truncated messages are never passed on
+    if (sysExOverflowed)
+        return;
+
+    // F0 + manufacturer ID + model
+    if (sysExSize >= 5 && std::equal(std::begin(mackieManufacturerId), std::end(mackieManufacturerId), sysExBuffer.begin() + 1))
+    {
+        const auto model = sysExBuffer[4];
+
+        if (model == huiModelId)
+            handler.protocolEvidence(ControlProtocol::Hui);
+        else if (model == mcuModelId || model == mcuExtenderModelId)
+            handler.protocolEvidence(ControlProtocol::Mcu);
+    }
+
+    handler.sysEx(sysExBuffer.data(), sysExSize);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "ProtocolDetector.h"
+
+/**
+ * Table-driven decoder for the MIDI a DAW sends back to a control surface.
+ * Status bytes and channel 1 controllers are dispatched through precomputed
+ * tables. Running status, interleaved real-time bytes and MCU/HUI sysex are
+ * handled from a raw byte stream with no allocation.
+ *
+ * A decoder is fed from a single thread (the MIDI input thread).
+ */
+class MidiDecoder
+{
+public:
+    /** Receives decoded events. All calls happen on the thread calling feed() */
+    class Handler
+    {
+    public:
+        virtual ~Handler() = default;
+
+        /** Pro Tools ping (note on 0, velocity 0 on channel 1). Not reported as protocol evidence,
+            an MCU host sends the same bytes to turn off REC ARM 1's LED */
+        virtual void huiPing() {}
+
+        /** One half of a HUI 14-bit fader position (CC 0-7 MSB, 32-39 LSB) */
+        virtual void huiFaderByte(int faderIndex, bool isMsb, int value) { juce::ignoreUnused(faderIndex, isMsb, value); }
+
+        /** MCU fader position, channels 1-16 as 0-15 */
+        virtual void pitchWheel(int channelIndex, int value) { juce::ignoreUnused(channelIndex, value); }
+
+        /** A meter level 0-12 for channels 1-8 as 0-7, from HUI poly aftertouch or MCU channel pressure */
+        virtual void meterLevel(int channelIndex, int level) { juce::ignoreUnused(channelIndex, level); }
+
+        /** A complete sysex message, including the F0 and F7 bytes */
+        virtual void sysEx(const uint8_t *data, int size) { juce::ignoreUnused(data, size); }
+
+        /** A message that only one of the two protocols would send */
+        virtual void protocolEvidence(ControlProtocol protocol) { juce::ignoreUnused(protocol); }
+    };
+
+    explicit MidiDecoder(Handler &handlerToUse) : handler(handlerToUse) {}
+
+    /** Decodes a chunk of raw MIDI bytes, continuing any message split across chunks */
+    void feed(const uint8_t *data, int size);
+
+    /** Forgets running status and any partial message */
+    void reset();
+
+    // Large enough for an MCU LCD update (header + offset + 112 characters)
+    static constexpr int maxSysExSize = 256;
+
+private:
+    void dispatchChannelMessage(uint8_t status, uint8_t data1, uint8_t data2);
+    void dispatchSysEx();
+
+    Handler &handler;
+
+    // Channel message in progress
+    uint8_t status = 0; // Also the running status once a channel message completes
+    int dataBytesNeeded = 0;
+    int numDataBytes = 0;
+    std::array<uint8_t, 2> dataBytes{};
+
+    // Sysex in progress
+    bool inSysEx = false;
+    bool sysExOverflowed = false;
+    int sysExSize = 0;
+    std::array<uint8_t, maxSysExSize> sysExBuffer{};
+
+    JUCE_DECLARE_NON_COPYABLE(MidiDecoder)
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Fixed-size MIDI 1.0 encoders for everything FaderEngine sends.
+ * Every burst is a std::array of complete 3-byte channel messages, so it can be
+ * built at compile time or on the stack and never touches the heap.
+ *
+ * Running status is deliberately not used: CoreMIDI packets must carry a status
+ * byte on every message, so each message in a burst is self-contained.
+ */
+namespace MidiEncoding
+{
+    constexpr size_t messageSize = 3;
+
+    template <size_t NumMessages>
+    using Burst = std::array<uint8_t, NumMessages * messageSize>;
+
+    // Status bytes (HUI and the MCU button notes always use channel 1)
+    constexpr uint8_t noteOffStatus = 0x80;
+    constexpr uint8_t noteOnStatus = 0x90;
+    constexpr uint8_t controllerStatus = 0xB0;
+    constexpr uint8_t pitchWheelStatus = 0xE0;
+
+    // HUI zone/port addressing
+    constexpr uint8_t huiZoneSelect = 0x0F;
+    constexpr uint8_t huiPortSelect = 0x2F;
+    constexpr uint8_t huiPortOn = 0x40;
+    constexpr uint8_t huiBankZone = 0x0A;
+
+    //==============================================================================
+    /** Reply to the Pro Tools ping (note on 0, velocity 127) */
+    constexpr Burst<1> huiPingReply{{noteOnStatus, 0x00, 0x7F}};
+
+    /** Touch, position (MSB/LSB) and release for one HUI fader */
+    constexpr Burst<6> huiFaderMove(int faderIndex, int value)
+    {
+        const auto fader = static_cast<uint8_t>(faderIndex & 0x07);
+        const auto msb = static_cast<uint8_t>((value >> 7) & 0x7F);
+        const auto lsb = static_cast<uint8_t>(value & 0x7F);
+
+        return {{
+            controllerStatus, huiZoneSelect, fader,                      // Select fader
+            controllerStatus, huiPortSelect, huiPortOn,                  // Apply touch pressure
+            controllerStatus, fader, msb,                                // Coarse position (MSB)
+            controllerStatus, static_cast<uint8_t>(0x20 | fader), lsb,   // Fine position (LSB)
+            controllerStatus, huiZoneSelect, fader,                      // Select fader again
+            controllerStatus, huiPortSelect, 0x00                        // Remove pressure
+        }};
+    }
+
+    /** HUI fader touch, held until huiRelease */
+    constexpr Burst<2> huiTouch(int faderIndex)
+    {
+        const auto fader = static_cast<uint8_t>(faderIndex & 0x07);
+        return {{
+            controllerStatus, huiZoneSelect, fader,
+            controllerStatus, huiPortSelect, huiPortOn
+        }};
+    }
+
+    /** HUI fader release */
+    constexpr Burst<2> huiRelease(int faderIndex)
+    {
+        const auto fader = static_cast<uint8_t>(faderIndex & 0x07);
+        return {{
+            controllerStatus, huiZoneSelect, fader,
+            controllerStatus, huiPortSelect, 0x00
+        }};
+    }
+
+    /** HUI fader position only, for a fader that is already touched */
+    constexpr Burst<2> huiPosition(int faderIndex, int value)
+    {
+        const auto fader = static_cast<uint8_t>(faderIndex & 0x07);
+        return {{
+            controllerStatus, fader, static_cast<uint8_t>((value >> 7) & 0x7F),
+            controllerStatus, static_cast<uint8_t>(0x20 | fader), static_cast<uint8_t>(value & 0x7F)
+        }};
+    }
+
+    //==============================================================================
+    // MCU fader touch notes are 104-111 (0x68-0x6F) for faders 1-8
+    constexpr uint8_t mcuFaderTouchNote = 0x68;
+
+    /** MCU fader touch */
+    constexpr Burst<1> mcuTouch(int faderIndex)
+    {
+        return {{noteOnStatus, static_cast<uint8_t>(mcuFaderTouchNote + (faderIndex & 0x07)), 0x7F}};
+    }
+
+    /** MCU fader release (note on with velocity 0, as MCU hardware sends it) */
+    constexpr Burst<1> mcuRelease(int faderIndex)
+    {
+        return {{noteOnStatus, static_cast<uint8_t>(mcuFaderTouchNote + (faderIndex & 0x07)), 0x00}};
+    }
+
+    /** MCU/Logic fader position, faders 1-8 on channels 1-8 */
+    constexpr Burst<1> pitchWheel(int faderIndex, int value)
+    {
+        return {{
+            static_cast<uint8_t>(pitchWheelStatus | (faderIndex & 0x0F)),
+            static_cast<uint8_t>(value & 0x7F),
+            static_cast<uint8_t>((value >> 7) & 0x7F)
+        }};
+    }
+
+    //==============================================================================
+    /** MCU button press and release */
+    constexpr Burst<2> mcuButton(uint8_t note)
+    {
+        return {{
+            noteOnStatus, note, 0x7F,
+            noteOffStatus, note, 0x00
+        }};
+    }
+
+    /** HUI zone select followed by a port press and release */
+    constexpr Burst<3> huiButton(uint8_t zone, uint8_t port)
+    {
+        return {{
+            controllerStatus, huiZoneSelect, zone,
+            controllerStatus, huiPortSelect, static_cast<uint8_t>(huiPortOn | port),
+            controllerStatus, huiPortSelect, port
+        }};
+    }
+
+    enum class BankAction
+    {
+        Left,
+        Right,
+        Left8,
+        Right8
+    };
+
+    struct BankBursts
+    {
+        Burst<2> mcu; // Logic/Ableton bank buttons
+        Burst<3> hui; // Pro Tools bank zone
+    };
+
+    /** Precompiled bank bursts, indexed by BankAction */
+    constexpr std::array<BankBursts, 4> bankBursts{{
+        {mcuButton(48), huiButton(huiBankZone, 0)}, // Left - single track
+        {mcuButton(49), huiButton(huiBankZone, 2)}, // Right - single track
+        {mcuButton(46), huiButton(huiBankZone, 1)}, // Left8 - bank of 8
+        {mcuButton(47), huiButton(huiBankZone, 3)}  // Right8 - bank of 8
+    }};
+
+    constexpr const BankBursts &getBankBursts(BankAction action)
+    {
+        return bankBursts[static_cast<size_t>(action)];
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Acceleration curves for engine-driven fader motion.
+ * A tap moves a fader by a fixed fine step; holding the key moves it
+ * continuously, ramping from fine to coarse speed the longer it is held.
+ */
+namespace MotionCurve
+{
+    enum class Shape
+    {
+        Constant,   // No acceleration, always the starting speed
+        Linear,     // Speed ramps evenly
+        Exponential // Stays fine for longer, then ramps quickly
+    };
+
+    /** Fine-to-coarse motion for one sensitivity setting. Speeds are in 14-bit steps */
+    struct Profile
+    {
+        int tapUp;               // Single press upward, in 14-bit steps
+        int tapDown;             // Single press downward, in 14-bit steps
+        double tapDb;            // Single press instead, on a fader taper measured from the DAW
+        double holdDelaySeconds; // Hold time before continuous motion starts
+        double startSpeed;       // Steps per second when continuous motion starts
+        double maxSpeed;         // Steps per second once fully ramped
+        double rampSeconds;      // Time to go from startSpeed to maxSpeed
+    };
+
+    /** Speed in steps per second, heldSeconds after continuous motion started */
+    inline double speedAt(const Profile &profile, Shape shape, double heldSeconds)
+    {
+        const double t = std::clamp(heldSeconds / profile.rampSeconds, 0.0, 1.0);
+
+        double amount = 0.0;
+        switch (shape)
+        {
+        case Shape::Constant:
+            amount = 0.0;
+            break;
+        case Shape::Linear:
+            amount = t;
+            break;
+        case Shape::Exponential:
+            amount = (std::exp(4.0 * t) - 1.0) / (std::exp(4.0) - 1.0);
+            break;
+        }
+
+        return profile.startSpeed + (profile.maxSpeed - profile.startSpeed) * amount;
+    }
+}
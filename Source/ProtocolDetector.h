@@ -0,0 +1,67 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+/** The control surface protocol the DAW is talking */
+enum class ControlProtocol
+{
+    Unknown, // Not sure yet, send both
+    Hui,     // Pro Tools
+    Mcu      // Logic, Ableton, Studio One, etc.
+};
+
+/**
+ * Works out which protocol the DAW is using from the MIDI it sends us.
+ * The decoder reports messages only one protocol would send: HUI hosts send
+ * the Pro Tools ping, HUI fader/zone CCs and HUI sysex; MCU hosts send pitch
+ * wheel fader feedback and MCU sysex. The ping only counts while the
+ * protocol isn't already MCU, where the same bytes are a REC ARM LED.
+ *
+ * addEvidence() runs on the MIDI input thread, getProtocol() can be read from any thread.
+ */
+class ProtocolDetector
+{
+public:
+    /** Records one message that only the given protocol would send */
+    void addEvidence(ControlProtocol evidence)
+    {
+        if (evidence == ControlProtocol::Unknown)
+            return;
+
+        // Evidence for one protocol counts against the other, so switching DAWs converges quickly
+        auto &forScore = evidence == ControlProtocol::Hui ? huiScore : mcuScore;
+        auto &againstScore = evidence == ControlProtocol::Hui ? mcuScore : huiScore;
+        forScore = juce::jmin(maxScore, forScore + 1);
+        againstScore = juce::jmax(0, againstScore - 1);
+
+        auto detected = ControlProtocol::Unknown;
+        if (huiScore >= confidentScore && mcuScore == 0)
+            detected = ControlProtocol::Hui;
+        else if (mcuScore >= confidentScore && huiScore == 0)
+            detected = ControlProtocol::Mcu;
+
+        protocol.store(detected);
+    }
+
+    /** The forced protocol if one is set, otherwise the detected one */
+    ControlProtocol getProtocol() const
+    {
+        const auto forced = forcedProtocol.load();
+        return forced != ControlProtocol::Unknown ? forced : protocol.load();
+    }
+
+    /** Skips detection, e.g. when the focused DAW's profile names its protocol. Unknown goes back to detecting */
+    void setForcedProtocol(ControlProtocol newProtocol) { forcedProtocol.store(newProtocol); }
+
+private:
+    static constexpr int confidentScore = 2;
+    static constexpr int maxScore = 16;
+
+    // Input thread only
+    int huiScore = 0;
+    int mcuScore = 0;
+
+    std::atomic<ControlProtocol> protocol{ControlProtocol::Unknown};
+    std::atomic<ControlProtocol> forcedProtocol{ControlProtocol::Unknown};
+};
@@ -1,6 +1,6 @@
 #include "RegistrationDialog.h"
 
-RegistrationDialog::RegistrationDialog(std::function<void(const juce::String&, std::function<void(bool)>)> registrationFunc)
+RegistrationDialog::RegistrationDialog(std::function<void(const juce::String&, std::function<void(RegistrationManager::Result)>)> registrationFunc)
     : onRegister(registrationFunc)
 {
     errorLabel.setColour(juce::Label::textColourId, juce::Colours::red);
@@ -26,18 +26,29 @@ void RegistrationDialog::attemptRegistration()
     errorLabel.setText("", juce::dontSendNotification);
     registerButton.setEnabled(false);
 
-    onRegister(serialNumberInput.getText(), [this](bool success)
+    // The dialog can be closed while the request is still on its way
+    onRegister(serialNumberInput.getText(), [safeThis = juce::Component::SafePointer<RegistrationDialog>(this)](RegistrationManager::Result result)
     {
-        registerButton.setEnabled(true);
+        if (safeThis == nullptr)
+            return;
 
-        if (success)
+        safeThis->registerButton.setEnabled(true);
+
+        switch (result)
         {
-            if (auto* dw = findParentComponentOfClass<juce::DialogWindow>())
+        case RegistrationManager::Result::Registered:
+            if (auto* dw = safeThis->findParentComponentOfClass<juce::DialogWindow>())
                 dw->exitModalState(1);
-        }
-        else
-        {
-            errorLabel.setText("Invalid serial number. Please try again.", juce::dontSendNotification);
+            break;
+        case RegistrationManager::Result::Rejected:
+            safeThis->errorLabel.setText("Invalid serial number. Please try again.", juce::dontSendNotification);
+            break;
+        case RegistrationManager::Result::NetworkError:
+            safeThis->errorLabel.setText("Couldn't reach the server. Please try again.", juce::dontSendNotification);
+            break;
+        case RegistrationManager::Result::Cancelled:
+        default:
+            break;
         }
     });
 }
@@ -63,7 +74,7 @@ void RegistrationDialog::resized()
     quitButton.setBounds(bounds.removeFromTop(30));
 }
 
-void RegistrationDialog::show(std::function<void(const juce::String&, std::function<void(bool)>)> onRegister)
+void RegistrationDialog::show(std::function<void(const juce::String&, std::function<void(RegistrationManager::Result)>)> onRegister)
 {
     auto dialog = std::make_unique<RegistrationDialog>(onRegister);
 
@@ -1,19 +1,20 @@
 #pragma once
 #include <JuceHeader.h>
+#include "RegistrationManager.h"
 
 class RegistrationDialog : public juce::Component
 {
 public:
-    RegistrationDialog(std::function<void(const juce::String&, std::function<void(bool)>)> registrationFunc);
+    RegistrationDialog(std::function<void(const juce::String&, std::function<void(RegistrationManager::Result)>)> registrationFunc);
 
-    static void show(std::function<void(const juce::String&, std::function<void(bool)>)> onRegister);
+    static void show(std::function<void(const juce::String&, std::function<void(RegistrationManager::Result)>)> onRegister);
 
 private:
     void attemptRegistration();
     void resized() override;
     void quit();
 
-    std::function<void(const juce::String&, std::function<void(bool)>)> onRegister;
+    std::function<void(const juce::String&, std::function<void(RegistrationManager::Result)>)> onRegister;
     juce::TextEditor serialNumberInput;
     juce::TextButton registerButton;
     juce::TextButton quitButton;
@@ -1,81 +1,252 @@
 #include "RegistrationManager.h"
+#include "LicenseToken.h"
+
+namespace
+{
+    constexpr const char* defaultServerUrl = "https://www.faderkeys.com/api/auth/serial";
+    constexpr int connectionTimeoutMs = 5000;
+
+    // Registrations from before tokens (the isRegistered setting alone, or a server that answers
+    // without a token) are trusted until 2027-04-01 UTC. The date is built in rather than stored,
+    // so editing the settings file can't extend it. After that only a verified token registers
+    constexpr juce::int64 legacyRegistrationCutoffMillis = 1806537600000;
+
+    bool isInLegacyGracePeriod()
+    {
+        return juce::Time::currentTimeMillis() < legacyRegistrationCutoffMillis;
+    }
+}
 
 RegistrationManager::RegistrationManager(juce::ApplicationProperties& properties)
-    : appProperties(properties)
+    : juce::Thread("Fader Keys Registration"),
+      appProperties(properties),
+      serverUrl(defaultServerUrl)
+{
+    startThread(juce::Thread::Priority::low);
+}
+
+RegistrationManager::~RegistrationManager()
 {
+    cancelPendingRequest();
+    stopThread(connectionTimeoutMs);
+    cancelPendingUpdate();
 }
 
 bool RegistrationManager::isRegistered() const
 {
     auto* settings = appProperties.getUserSettings();
-    return settings->getBoolValue("isRegistered", false);
+    const auto token = settings->getValue("licenseToken");
+
+    // Registered before tokens existed, refreshLegacyRegistrationAsync upgrades it when the server is reachable.
+    // Once a token has been stored the setting on its own no longer counts
+    if (token.isEmpty())
+        return isInLegacyGracePeriod()
+            && !settings->getBoolValue("hadLicenseToken", false)
+            && settings->getBoolValue("isRegistered", false);
+
+    const auto claims = LicenseToken::verify(token);
+    return claims.has_value() && claims->serialNumber == settings->getValue("serialNumber");
+}
+
+void RegistrationManager::setServerUrl(const juce::URL& newUrl)
+{
+    const juce::ScopedLock sl(requestLock);
+    serverUrl = newUrl;
 }
 
+// REQUESTS (MESSAGE THREAD)
+//==============================================================================
 void RegistrationManager::registerSerialNumberAsync(const juce::String& serialNumber,
-                                                    std::function<void(bool)> callback)
+                                                    std::function<void(Result)> callback)
+{
+    std::optional<Request> replaced;
+
+    {
+        const juce::ScopedLock sl(requestLock);
+        replaced.swap(pendingRequest);
+        pendingRequest = Request{serialNumber, std::move(callback)};
+
+        // Only the newest request matters, so one still on the wire is dropped
+        if (requestInFlight)
+            cancelRequested = true;
+    }
+
+    {
+        const juce::ScopedLock sl(streamLock);
+        if (cancelRequested && activeStream != nullptr)
+            activeStream->cancel();
+    }
+
+    if (replaced.has_value() && replaced->callback)
+        juce::MessageManager::callAsync([callback = std::move(replaced->callback)] { callback(Result::Cancelled); });
+
+    notify();
+}
+
+void RegistrationManager::refreshLegacyRegistrationAsync()
+{
+    auto* settings = appProperties.getUserSettings();
+    const auto serialNumber = settings->getValue("serialNumber");
+
+    if (settings->getBoolValue("isRegistered", false)
+        && settings->getValue("licenseToken").isEmpty()
+        && serialNumber.isNotEmpty())
+        registerSerialNumberAsync(serialNumber, nullptr);
+}
+
+void RegistrationManager::cancelPendingRequest()
+{
+    std::optional<Request> cancelled;
+
+    {
+        const juce::ScopedLock sl(requestLock);
+        cancelled.swap(pendingRequest);
+
+        if (requestInFlight)
+            cancelRequested = true;
+    }
+
+    {
+        const juce::ScopedLock sl(streamLock);
+        if (cancelRequested && activeStream != nullptr)
+            activeStream->cancel();
+    }
+
+    if (cancelled.has_value() && cancelled->callback)
+        juce::MessageManager::callAsync([callback = std::move(cancelled->callback)] { callback(Result::Cancelled); });
+}
+
+void RegistrationManager::handleAsyncUpdate()
+{
+    std::optional<Request> request;
+    Result result = Result::Cancelled;
+    juce::String token;
+
+    {
+        const juce::ScopedLock sl(requestLock);
+        request.swap(finishedRequest);
+        result = finishedResult;
+        token = finishedToken;
+    }
+
+    if (!request.has_value())
+        return;
+
+    if (result == Result::Registered)
+        storeRegistration(request->serialNumber, token);
+
+    if (request->callback)
+        request->callback(result);
+}
+
+void RegistrationManager::storeRegistration(const juce::String& serialNumber, const juce::String& token)
 {
-    // Create a shared pointer to store the thread
-    auto thread = std::make_shared<std::thread>([this, serialNumber, callback]()
+    auto* settings = appProperties.getUserSettings();
+    settings->setValue("isRegistered", true);
+    settings->setValue("serialNumber", serialNumber);
+
+    // A server from before tokens only confirms the serial
+    if (token.isNotEmpty())
     {
-        const bool isValid = validateSerialNumber(serialNumber);
+        settings->setValue("licenseToken", token);
+        settings->setValue("hadLicenseToken", true);
+    }
+
+    settings->saveIfNeeded();
+}
+
+// WORKER THREAD
+//==============================================================================
+void RegistrationManager::run()
+{
+    while (!threadShouldExit())
+    {
+        std::optional<Request> request;
 
-        if (isValid)
         {
-            // Store registration info in settings if valid
-            auto* settings = appProperties.getUserSettings();
-            settings->setValue("isRegistered", true);
-            settings->setValue("serialNumber", serialNumber);
-            settings->saveIfNeeded();
+            const juce::ScopedLock sl(requestLock);
+            request.swap(pendingRequest);
+            requestInFlight = request.has_value();
+            cancelRequested = false;
         }
 
-        // Call the callback on the message thread
-        juce::MessageManager::callAsync([callback, isValid]()
+        if (!request.has_value())
         {
-            if (callback)
-                callback(isValid);
-        });
-    });
+            wait(-1);
+            continue;
+        }
+
+        juce::String token;
+        auto result = requestToken(request->serialNumber, token);
+
+        const juce::ScopedLock sl(requestLock);
+        requestInFlight = false;
+
+        if (cancelRequested || threadShouldExit())
+            result = Result::Cancelled;
 
-    // Detach the thread after creating it
-    thread->detach();
+        // Results are picked up on the message thread. A newer request is already queued
+        // whenever one finishes cancelled, so only the latest result ever waits here
+        finishedRequest = std::move(request);
+        finishedResult = result;
+        finishedToken = token;
+        triggerAsyncUpdate();
+    }
 }
 
-bool RegistrationManager::validateSerialNumber(const juce::String& serialNumber)
+RegistrationManager::Result RegistrationManager::requestToken(const juce::String& serialNumber, juce::String& token)
 {
-    try
+    juce::var jsonBody = juce::var(new juce::DynamicObject());
+    jsonBody.getDynamicObject()->setProperty("serialNumber", serialNumber);
+
+    juce::URL url;
     {
-        juce::URL url("https://www.faderkeys.com/api/auth/serial");
+        const juce::ScopedLock sl(requestLock);
+        url = serverUrl.withPOSTData(juce::JSON::toString(jsonBody));
+    }
 
-        juce::var jsonBody = juce::var(new juce::DynamicObject());
-        jsonBody.getDynamicObject()->setProperty("serialNumber", serialNumber);
+    juce::WebInputStream stream(url, true);
+    stream.withExtraHeaders("Content-Type: application/json")
+          .withConnectionTimeout(connectionTimeoutMs);
 
-        auto opts = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inPostData)
-                       .withExtraHeaders("Content-Type: application/json")
-                       .withConnectionTimeoutMs(5000);
+    {
+        const juce::ScopedLock sl(streamLock);
+        if (cancelRequested)
+            return Result::Cancelled;
 
-        url = url.withPOSTData(juce::JSON::toString(jsonBody));
+        activeStream = &stream;
+    }
 
-        // Create the input stream and wait for response
-        auto inputStream = url.createInputStream(opts);
-        if (inputStream != nullptr)
-        {
-            if (auto* webStream = dynamic_cast<juce::WebInputStream*>(inputStream.get()))
-            {
-                // Wait for the full response
-                auto response = inputStream->readEntireStreamAsString();
-                return webStream->getStatusCode() == 200;
-            }
-        }
+    const bool connected = stream.connect(nullptr);
+    const int statusCode = connected ? stream.getStatusCode() : 0;
+    const auto response = statusCode == 200 ? stream.readEntireStreamAsString() : juce::String();
+
+    {
+        const juce::ScopedLock sl(streamLock);
+        activeStream = nullptr;
     }
-    catch (const std::exception& e)
+
+    if (cancelRequested)
+        return Result::Cancelled;
+
+    if (statusCode == 401 || statusCode == 403)
+        return Result::Rejected;
+
+    if (statusCode != 200)
+        return Result::NetworkError;
+
+    // A server from before tokens only confirms the serial, which counts during the grace period
+    token = juce::JSON::parse(response).getProperty("token", {}).toString();
+    if (token.isEmpty())
+        return isInLegacyGracePeriod() ? Result::Registered : Result::NetworkError;
+
+    // Never store a token that wouldn't pass the startup check
+    const auto claims = LicenseToken::verify(token);
+    if (!claims.has_value() || claims->serialNumber != serialNumber)
     {
-        DBG("Network error: " << e.what());
+        token = {};
+        return Result::NetworkError;
     }
 
-    // For development, return true to bypass validation
-    #if JUCE_DEBUG
-    return true;
-    #else
-    return false;
-    #endif
+    return Result::Registered;
 }
@@ -1,20 +1,80 @@
 #pragma once
 #include <JuceHeader.h>
+#include <optional>
 
-class RegistrationManager
+/**
+ * Registration state and the one worker thread that talks to the license server.
+ *
+ * A successful registration stores a signed token (see LicenseToken), which
+ * isRegistered() checks locally, so startup never waits on the network.
+ * Server requests run one at a time on the worker and can be cancelled;
+ * their callbacks always arrive on the message thread.
+ */
+class RegistrationManager : private juce::Thread,
+                            private juce::AsyncUpdater
 {
 public:
+    enum class Result
+    {
+        Registered,
+        Rejected,     // The server turned the serial down
+        NetworkError, // No answer, or one we couldn't use
+        Cancelled
+    };
+
     RegistrationManager(juce::ApplicationProperties& properties);
+    ~RegistrationManager() override;
 
+    /** Checks the stored token against the built-in key. A registration from before tokens
+        counts until the legacy grace period ends. No network I/O */
     bool isRegistered() const;
-    // bool registerSerialNumber(const juce::String& serialNumber);
+
+    /** Validates a serial on the worker thread. A new request cancels one still in flight */
     void registerSerialNumberAsync(const juce::String& serialNumber,
-                                   std::function<void(bool)> callback);
+                                   std::function<void(Result)> callback);
+
+    /** Fetches a token in the background for a serial registered before tokens existed */
+    void refreshLegacyRegistrationAsync();
+
+    /** Cancels the queued and in-flight requests, their callbacks get Cancelled */
+    void cancelPendingRequest();
+
+    /** Sends requests somewhere else, e.g. the local stub server */
+    void setServerUrl(const juce::URL& newUrl);
 
 private:
-    bool validateSerialNumber(const juce::String& serialNumber);
+    struct Request
+    {
+        juce::String serialNumber;
+        std::function<void(Result)> callback;
+    };
+
+    void run() override;
+
+    /** Stores the finished request's result and calls its callback (message thread) */
+    void handleAsyncUpdate() override;
+
+    /** Posts the serial and checks the token that comes back (worker thread) */
+    Result requestToken(const juce::String& serialNumber, juce::String& token);
+
+    /** Stores a registration (message thread) */
+    void storeRegistration(const juce::String& serialNumber, const juce::String& token);
 
     juce::ApplicationProperties& appProperties;
 
+    // Requests waiting for the worker and the one it finished last, and the server they go to
+    juce::CriticalSection requestLock;
+    std::optional<Request> pendingRequest;
+    std::optional<Request> finishedRequest;
+    Result finishedResult = Result::Cancelled;
+    juce::String finishedToken;
+    bool requestInFlight = false;
+    juce::URL serverUrl;
+
+    // The connection in flight, so a cancel can abort it mid-request
+    juce::CriticalSection streamLock;
+    juce::WebInputStream* activeStream = nullptr;
+    std::atomic<bool> cancelRequested{false};
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RegistrationManager)
 };
@@ -0,0 +1,141 @@
+#include "SceneSnapshots.h"
+
+namespace
+{
+    // snapshots.json:
+    // {"snapshots": [{"slot": 1-8, "name": "Verse", "bank": <track offset, 0 if left out>, "positions": [0-16383, ...]}]}
+    juce::String getDefaultName(int slot)
+    {
+        return "Snapshot " + juce::String(slot + 1);
+    }
+}
+
+// CONSTRUCTOR / DESTRUCTOR
+//==============================================================================
+SceneSnapshots::SceneSnapshots()
+{
+    for (int i = 0; i < numSlots; ++i)
+        names[(size_t)i] = getDefaultName(i);
+}
+
+SceneSnapshots::~SceneSnapshots()
+{
+    // Anything stored since the last save still goes to disk
+    if (isUpdatePending())
+    {
+        cancelPendingUpdate();
+        handleAsyncUpdate();
+    }
+}
+
+// LOADING / SAVING
+//==============================================================================
+void SceneSnapshots::loadFromFile(const juce::File &fileToUse)
+{
+    file = fileToUse;
+
+    if (!file.existsAsFile())
+        return;
+
+    const auto root = juce::JSON::parse(file.loadFileAsString());
+    const auto *snapshotArray = root["snapshots"].getArray();
+
+    if (snapshotArray == nullptr)
+    {
+        DBG("Snapshots file has no \"snapshots\" array");
+        return;
+    }
+
+    const juce::SpinLock::ScopedLockType sl(lock);
+
+    for (const auto &entry : *snapshotArray)
+    {
+        const int slot = (int)entry.getProperty("slot", 0) - 1;
+        const auto *positionArray = entry["positions"].getArray();
+
+        if (slot < 0 || slot >= numSlots || positionArray == nullptr)
+            continue;
+
+        auto &snapshot = slots[(size_t)slot];
+        snapshot.bankOffset = juce::jmax(0, (int)entry.getProperty("bank", 0));
+        snapshot.numFaders = juce::jmin(maxFaders, positionArray->size());
+
+        for (int i = 0; i < snapshot.numFaders; ++i)
+            snapshot.positions[(size_t)i] = juce::jlimit(0, FaderState::maxValue, (int)positionArray->getReference(i));
+
+        snapshot.isStored = true;
+        names[(size_t)slot] = entry.getProperty("name", getDefaultName(slot)).toString();
+    }
+}
+
+void SceneSnapshots::handleAsyncUpdate()
+{
+    if (file == juce::File())
+        return;
+
+    std::array<Snapshot, numSlots> copies;
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+        copies = slots;
+    }
+
+    juce::Array<juce::var> snapshotArray;
+
+    for (int slot = 0; slot < numSlots; ++slot)
+    {
+        const auto &snapshot = copies[(size_t)slot];
+        if (!snapshot.isStored)
+            continue;
+
+        juce::Array<juce::var> positions;
+        for (int i = 0; i < snapshot.numFaders; ++i)
+            positions.add(snapshot.positions[(size_t)i]);
+
+        auto *entry = new juce::DynamicObject();
+        entry->setProperty("slot", slot + 1);
+        entry->setProperty("name", names[(size_t)slot]);
+        entry->setProperty("bank", snapshot.bankOffset);
+        entry->setProperty("positions", positions);
+        snapshotArray.add(juce::var(entry));
+    }
+
+    auto *root = new juce::DynamicObject();
+    root->setProperty("snapshots", snapshotArray);
+
+    if (!file.replaceWithText(juce::JSON::toString(juce::var(root))))
+        DBG("Failed to save snapshots to " << file.getFullPathName());
+}
+
+// SLOTS
+//==============================================================================
+void SceneSnapshots::store(int slot, int bankOffset, const int *positions, int numFaders)
+{
+    if (slot < 0 || slot >= numSlots)
+        return;
+
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+
+        auto &snapshot = slots[(size_t)slot];
+        snapshot.bankOffset = bankOffset;
+        snapshot.numFaders = juce::jmin(maxFaders, numFaders);
+        std::copy(positions, positions + snapshot.numFaders, snapshot.positions.begin());
+        snapshot.isStored = true;
+    }
+
+    triggerAsyncUpdate();
+}
+
+SceneSnapshots::Snapshot SceneSnapshots::get(int slot) const
+{
+    if (slot < 0 || slot >= numSlots)
+        return {};
+
+    const juce::SpinLock::ScopedLockType sl(lock);
+    return slots[(size_t)slot];
+}
+
+juce::String SceneSnapshots::getName(int slot) const
+{
+    return slot >= 0 && slot < numSlots ? names[(size_t)slot] : juce::String();
+}
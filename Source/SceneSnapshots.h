@@ -0,0 +1,60 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "FaderState.h"
+
+/**
+ * Named fader snapshots, one per slot, saved to snapshots.json next to the
+ * settings file. A snapshot holds every fader of every surface for the bank
+ * that was showing when it was stored, and the bank offset it was stored
+ * at, so position i belongs to track bankOffset + i.
+ *
+ * The engine thread stores and reads slots under a spin lock held for one
+ * copy. Saving happens on the message thread, so storing never touches
+ * the disk.
+ */
+class SceneSnapshots : private juce::AsyncUpdater
+{
+public:
+    static constexpr int numSlots = 8;
+    static constexpr int maxFaders = 32;
+
+    struct Snapshot
+    {
+        bool isStored = false;
+        int bankOffset = 0; // Track index of the first position
+        int numFaders = 0;
+        std::array<int, maxFaders> positions{};
+    };
+
+    SceneSnapshots();
+    ~SceneSnapshots() override;
+
+    /** Loads snapshots from a file and saves there from now on. Call from the message thread */
+    void loadFromFile(const juce::File &file);
+
+    /** Stores the positions of tracks bankOffset onwards in a slot and queues a save.
+        Safe to call from the engine thread */
+    void store(int slot, int bankOffset, const int *positions, int numFaders);
+
+    /** A copy of a slot, isStored is false if nothing was stored there. Safe to call from the engine thread */
+    Snapshot get(int slot) const;
+
+    /** A slot's name, "Snapshot N" unless renamed in the file. Call from the message thread */
+    juce::String getName(int slot) const;
+
+private:
+    /** Writes every stored slot to the file (message thread) */
+    void handleAsyncUpdate() override;
+
+    juce::File file;
+
+    mutable juce::SpinLock lock;
+    std::array<Snapshot, numSlots> slots{};
+
+    // Only changed while loading, so the engine thread never reads them
+    std::array<juce::String, numSlots> names;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SceneSnapshots)
+};
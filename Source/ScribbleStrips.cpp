@@ -0,0 +1,115 @@
+#include "ScribbleStrips.h"
+
+namespace
+{
+    // F0 00 00 66 <model>
+    constexpr uint8_t mackieManufacturerId[] = {0x00, 0x00, 0x66};
+    constexpr int headerSize = 5;
+
+    // MCU LCD: F0 00 00 66 14|15 12 <offset> <characters> F7, offsets 0-55 are the top row
+    constexpr uint8_t mcuModelId = 0x14;
+    constexpr uint8_t mcuExtenderModelId = 0x15;
+    constexpr uint8_t mcuLcdCommand = 0x12;
+    constexpr int mcuTopRowLength = ScribbleStrips::numChannels * ScribbleStrips::maxNameLength;
+
+    // HUI channel displays: F0 00 00 66 05 00 10 <display 0-7> <4 characters> [...] F7
+    constexpr uint8_t huiModelId = 0x05;
+    constexpr uint8_t huiSmallDisplayCommand = 0x10;
+    constexpr int huiNameLength = 4;
+
+    // Both displays use ASCII for the printable range, the rest are symbols we show as spaces
+    char toPrintable(uint8_t character)
+    {
+        return character >= 0x20 && character < 0x7F ? (char)character : ' ';
+    }
+}
+
+// DECODING (MIDI INPUT THREAD)
+//==============================================================================
+void ScribbleStrips::handleSysEx(const uint8_t *data, int size)
+{
+    // Header, command byte and at least one more byte before the F7
+    if (size < headerSize + 3
+        || !std::equal(std::begin(mackieManufacturerId), std::end(mackieManufacturerId), data + 1))
+        return;
+
+    const auto model = data[4];
+    const int end = size - 1; // Before the F7
+    bool changed = false;
+
+    if ((model == mcuModelId || model == mcuExtenderModelId) && data[5] == mcuLcdCommand)
+    {
+        const int offset = data[6];
+        const int numChars = juce::jmin(end - 7, mcuTopRowLength - offset);
+
+        // Each channel's cell gets the part of the update that falls on it
+        for (int i = 0; i < numChars;)
+        {
+            const int position = offset + i;
+            const int channelIndex = position / maxNameLength;
+            const int column = position % maxNameLength;
+            const int numInCell = juce::jmin(numChars - i, maxNameLength - column);
+
+            changed |= setChars(channelIndex, column, data + 7 + i, numInCell);
+            i += numInCell;
+        }
+    }
+    else if (model == huiModelId && data[5] == 0x00 && data[6] == huiSmallDisplayCommand)
+    {
+        // One display index and 4 characters per display, several can share a message
+        for (int i = 7; i + 1 + huiNameLength <= end; i += 1 + huiNameLength)
+        {
+            const int channelIndex = data[i];
+            if (channelIndex >= numChannels)
+                continue;
+
+            // Clears the rest of the cell, which only an MCU would fill
+            constexpr uint8_t padding[maxNameLength - huiNameLength]{0x20, 0x20, 0x20};
+            changed |= setChars(channelIndex, 0, data + i + 1, huiNameLength);
+            changed |= setChars(channelIndex, huiNameLength, padding, (int)sizeof(padding));
+        }
+    }
+
+    if (changed)
+        changeCount.fetch_add(1, std::memory_order_release);
+}
+
+bool ScribbleStrips::setChars(int channelIndex, int position, const uint8_t *chars, int numChars)
+{
+    const juce::SpinLock::ScopedLockType sl(lock);
+
+    auto &name = names[(size_t)channelIndex];
+    bool changed = false;
+
+    for (int i = 0; i < numChars; ++i)
+    {
+        const char character = toPrintable(chars[i]);
+        auto &slot = name[(size_t)(position + i)];
+
+        if (slot != character)
+        {
+            slot = character;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+// READING (MESSAGE THREAD)
+//==============================================================================
+juce::String ScribbleStrips::getName(int channelIndex) const
+{
+    if (channelIndex < 0 || channelIndex >= numChannels)
+        return {};
+
+    std::array<char, maxNameLength> name;
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+        name = names[(size_t)channelIndex];
+    }
+
+    // Cells the DAW hasn't written yet are still zeros
+    std::replace(name.begin(), name.end(), '\0', ' ');
+    return juce::String(name.data(), name.size()).trim();
+}
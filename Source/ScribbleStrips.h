@@ -0,0 +1,41 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "FaderState.h"
+
+/**
+ * Track names for one surface's channels, picked out of the display sysex
+ * the DAW streams to it: the MCU LCD's top row (7 characters per channel)
+ * or the HUI's 4-character channel displays.
+ *
+ * Each update is written into fixed per-channel buffers in place, so the
+ * MIDI input thread never allocates. Readers poll the change count and
+ * only copy names out when it has moved.
+ */
+class ScribbleStrips
+{
+public:
+    static constexpr int numChannels = FaderState::numFaders;
+
+    // One MCU LCD cell, HUI names use the first 4
+    static constexpr int maxNameLength = 7;
+
+    /** Updates names from a display sysex, anything else is ignored (MIDI input thread) */
+    void handleSysEx(const uint8_t *data, int size);
+
+    /** A channel's name with the padding trimmed, empty until the DAW sends one. Call from the message thread */
+    juce::String getName(int channelIndex) const;
+
+    /** Goes up whenever a name changes. Safe to call from any thread */
+    uint32_t getChangeCount() const { return changeCount.load(std::memory_order_acquire); }
+
+private:
+    /** Writes characters into a channel's name from a position, returns true if anything changed */
+    bool setChars(int channelIndex, int position, const uint8_t *chars, int numChars);
+
+    mutable juce::SpinLock lock;
+    std::array<std::array<char, maxNameLength>, numChannels> names{};
+    std::atomic<uint32_t> changeCount{0};
+};
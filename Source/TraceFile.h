@@ -0,0 +1,93 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstring>
+
+/**
+ * On-disk layout of a key/MIDI trace: a 16-byte header followed by fixed
+ * 16-byte records, appended in time order. Fixed records keep the file
+ * seekable and let a reader map it and index it directly.
+ */
+namespace TraceFile
+{
+    enum class RecordType : uint8_t
+    {
+        Key,     // Key event handled by the engine
+        MidiOut, // 1-3 byte message sent to the DAW
+        MidiIn   // 1-3 byte message received from the DAW
+    };
+
+    // Key record flags
+    constexpr uint8_t keyDownFlag = 0x01;
+    constexpr uint8_t repeatFlag = 0x02;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+    };
+
+    struct Record
+    {
+        uint64_t timeMicros; // Since recording started
+        RecordType type;
+        uint8_t surface;     // MIDI records: surface index
+        uint8_t size;        // MIDI records: message size
+        uint8_t flags;       // Key records: keyDownFlag | repeatFlag
+        uint8_t data[4];     // Key records: keycode, modifiers. MIDI records: message bytes
+    };
+
+    static_assert(sizeof(Header) == 16, "Trace header must stay 16 bytes");
+    static_assert(sizeof(Record) == 16, "Trace records must stay 16 bytes");
+
+    constexpr char magic[8] = {'F', 'K', 'T', 'R', 'A', 'C', 'E', '\0'};
+    constexpr uint32_t version = 1;
+
+    inline Header makeHeader()
+    {
+        Header header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.recordSize = sizeof(Record);
+        return header;
+    }
+
+    //==============================================================================
+    /** Read-only, memory-mapped view of a trace file */
+    class Reader
+    {
+    public:
+        explicit Reader(const juce::File &file)
+            : mappedFile(file, juce::MemoryMappedFile::readOnly)
+        {
+            if (mappedFile.getData() == nullptr || mappedFile.getSize() < sizeof(Header))
+                return;
+
+            const auto &header = *static_cast<const Header *>(mappedFile.getData());
+            if (std::memcmp(header.magic, magic, sizeof(magic)) != 0
+                || header.version != version
+                || header.recordSize != sizeof(Record))
+                return;
+
+            records = reinterpret_cast<const Record *>(static_cast<const char *>(mappedFile.getData()) + sizeof(Header));
+
+            // A trace cut short mid-record just loses its last record
+            numRecords = (int)((mappedFile.getSize() - sizeof(Header)) / sizeof(Record));
+        }
+
+        bool isValid() const { return records != nullptr; }
+        int getNumRecords() const { return numRecords; }
+        const Record &operator[](int index) const { return records[index]; }
+
+        const Record *begin() const { return records; }
+        const Record *end() const { return records + numRecords; }
+
+    private:
+        juce::MemoryMappedFile mappedFile;
+        const Record *records = nullptr;
+        int numRecords = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(Reader)
+    };
+}
@@ -0,0 +1,137 @@
+#include "TraceRecorder.h"
+
+namespace
+{
+    // How often the writer thread moves records from the ring to the file
+    constexpr int drainIntervalMs = 50;
+}
+
+// CONSTRUCTOR / DESTRUCTOR
+//==============================================================================
+TraceRecorder::TraceRecorder()
+    : juce::Thread("Fader Keys Trace Writer")
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    stop();
+}
+
+// START / STOP
+//==============================================================================
+bool TraceRecorder::start(const juce::File &file)
+{
+    stop();
+
+    file.deleteFile();
+    stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if (!stream->openedOk())
+    {
+        DBG("Failed to open trace file " << file.getFullPathName());
+        stream.reset();
+        return false;
+    }
+
+    const auto header = TraceFile::makeHeader();
+    stream->write(&header, sizeof(header));
+
+    fifo.reset();
+    numDropped.store(0);
+    startTicks.store(juce::Time::getHighResolutionTicks());
+    recording.store(true, std::memory_order_release);
+
+    startThread(juce::Thread::Priority::low);
+    return true;
+}
+
+void TraceRecorder::stop()
+{
+    if (!isRecording())
+        return;
+
+    recording.store(false);
+    stopThread(1000);
+
+    drain();
+    stream->flush();
+    stream.reset();
+
+    if (numDropped.load() > 0)
+        DBG("Trace dropped " << numDropped.load() << " records");
+}
+
+// RECORDING
+//==============================================================================
+void TraceRecorder::recordKey(int keyCode, bool isKeyDown, int modifiers, bool isRepeat)
+{
+    if (!isRecording())
+        return;
+
+    TraceFile::Record record{};
+    record.type = TraceFile::RecordType::Key;
+    record.flags = (uint8_t)((isKeyDown ? TraceFile::keyDownFlag : 0) | (isRepeat ? TraceFile::repeatFlag : 0));
+    record.data[0] = (uint8_t)keyCode;
+    record.data[1] = (uint8_t)modifiers;
+    push(record);
+}
+
+void TraceRecorder::recordMidi(TraceFile::RecordType type, int surfaceIndex, const uint8_t *data, int size)
+{
+    // Sysex doesn't fit a record and isn't part of the fader path
+    if (!isRecording() || size < 1 || size > 3)
+        return;
+
+    TraceFile::Record record{};
+    record.type = type;
+    record.surface = (uint8_t)surfaceIndex;
+    record.size = (uint8_t)size;
+    std::copy(data, data + size, record.data);
+    push(record);
+}
+
+void TraceRecorder::push(TraceFile::Record record)
+{
+    const juce::SpinLock::ScopedLockType lock(pushLock);
+
+    // Stamped under the lock, so the trace stays in time order across threads
+    const auto elapsed = juce::Time::getHighResolutionTicks() - startTicks.load(std::memory_order_acquire);
+    record.timeMicros = (uint64_t)(juce::Time::highResolutionTicksToSeconds(elapsed) * 1.0e6);
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 < 1)
+    {
+        ++numDropped;
+        return;
+    }
+
+    records[(size_t)(size1 > 0 ? start1 : start2)] = record;
+    fifo.finishedWrite(1);
+}
+
+// WRITER THREAD
+//==============================================================================
+void TraceRecorder::run()
+{
+    while (!threadShouldExit())
+    {
+        drain();
+        wait(drainIntervalMs);
+    }
+}
+
+void TraceRecorder::drain()
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+    if (size1 > 0)
+        stream->write(records.data() + start1, (size_t)size1 * sizeof(TraceFile::Record));
+    if (size2 > 0)
+        stream->write(records.data() + start2, (size_t)size2 * sizeof(TraceFile::Record));
+
+    fifo.finishedRead(size1 + size2);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "TraceFile.h"
+
+/**
+ * Appends every key event and MIDI message to a binary trace (see TraceFile).
+ * Records are pushed into a preallocated ring from the engine and MIDI
+ * threads and written out by a background thread, so recording never
+ * touches the disk on the key path. While not recording, each call is one
+ * relaxed atomic load.
+ */
+class TraceRecorder : private juce::Thread
+{
+public:
+    TraceRecorder();
+    ~TraceRecorder() override;
+
+    /** Starts a new trace, replacing the file. Not for the engine or MIDI threads */
+    bool start(const juce::File &file);
+
+    /** Writes out what is still buffered and closes the trace. Not for the engine or MIDI threads */
+    void stop();
+
+    bool isRecording() const { return recording.load(std::memory_order_relaxed); }
+
+    /** Records that didn't fit in the ring since the trace started */
+    int getNumDropped() const { return numDropped.load(); }
+
+    // Safe to call from any thread
+    void recordKey(int keyCode, bool isKeyDown, int modifiers, bool isRepeat);
+    void recordMidi(TraceFile::RecordType type, int surfaceIndex, const uint8_t *data, int size);
+
+private:
+    static constexpr int capacity = 8192;
+
+    void run() override;
+    void push(TraceFile::Record record);
+
+    /** Writes buffered records to the file (writer thread, or after it stopped) */
+    void drain();
+
+    std::atomic<bool> recording{false};
+    std::atomic<juce::int64> startTicks{0};
+    std::atomic<int> numDropped{0};
+
+    // Several threads record, so pushes are serialised by a spin lock held for one copy
+    juce::SpinLock pushLock;
+    juce::AbstractFifo fifo{capacity};
+    std::array<TraceFile::Record, capacity> records{};
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceRecorder)
+};
@@ -0,0 +1,235 @@
+#include "TraceReplay.h"
+
+namespace
+{
+    constexpr const char *replayFlag = "--replay-trace";
+
+    // Time for rate-limited moves and releases to go out after the last record
+    constexpr int settleMs = 250;
+
+    // How long the engine thread gets to handle the keys ahead of a MIDI-in record
+    constexpr int engineTimeoutMs = 5000;
+
+    bool isSameMessage(const TraceFile::Record &a, const TraceFile::Record &b)
+    {
+        return a.surface == b.surface
+               && a.size == b.size
+               && std::equal(a.data, a.data + a.size, b.data);
+    }
+
+    juce::String describe(const TraceFile::Record &record)
+    {
+        juce::String text = "surface " + juce::String(record.surface + 1) + ":";
+        for (int i = 0; i < record.size; ++i)
+            text << " " << juce::String::toHexString(record.data[i]).paddedLeft('0', 2);
+        return text;
+    }
+}
+
+// CONSTRUCTOR / DESTRUCTOR
+//==============================================================================
+TraceReplay::TraceReplay(FaderEngine &engineToDrive, const juce::File &traceToReplay, bool shouldReplayInRealtime,
+                         const juce::File &goldenTrace, const juce::File &outputTrace)
+    : juce::Thread("Fader Keys Trace Replay"),
+      engine(engineToDrive),
+      traceFile(traceToReplay),
+      isRealtime(shouldReplayInRealtime),
+      goldenFile(goldenTrace == juce::File() ? traceToReplay : goldenTrace),
+      outputFile(outputTrace == juce::File() ? juce::File::createTempFile(".fktrace") : outputTrace)
+{
+    // The key event counter tells the replay when the engine thread has caught up
+    engine.setRecordingStats(true);
+
+    // Recorded feedback is the only feedback, a DAW on the real ports would write alongside it
+    engine.detachMidiInputs();
+    startThread();
+}
+
+TraceReplay::~TraceReplay()
+{
+    stopThread(2000);
+    engine.getTraceRecorder().stop();
+}
+
+bool TraceReplay::isRequested(const juce::String &commandLine)
+{
+    return commandLine.contains(replayFlag);
+}
+
+std::unique_ptr<TraceReplay> TraceReplay::createFromCommandLine(FaderEngine &engine, const juce::String &commandLine)
+{
+    const auto args = juce::StringArray::fromTokens(commandLine, true);
+
+    const auto getFileArg = [&args](const char *flag) {
+        const int index = args.indexOf(flag);
+        return index >= 0 ? juce::File::getCurrentWorkingDirectory().getChildFile(args[index + 1].unquoted())
+                          : juce::File();
+    };
+
+    return std::make_unique<TraceReplay>(engine,
+                                         getFileArg(replayFlag),
+                                         args.contains("--realtime"),
+                                         getFileArg("--golden"),
+                                         getFileArg("--output"));
+}
+
+// REPLAY THREAD
+//==============================================================================
+void TraceReplay::run()
+{
+    int result = 1;
+
+    if (!engine.getTraceRecorder().start(outputFile))
+    {
+        juce::Logger::writeToLog("Trace replay: could not write " + outputFile.getFullPathName());
+    }
+    else if (!replay())
+    {
+        engine.getTraceRecorder().stop();
+        juce::Logger::writeToLog("Trace replay: " + traceFile.getFullPathName() + " is not a Fader Keys trace");
+    }
+    else if (!isRealtime)
+    {
+        engine.getTraceRecorder().stop();
+        juce::Logger::writeToLog("Output written to " + outputFile.getFullPathName()
+                                 + ", not compared: timing-dependent output only matches with --realtime");
+        result = 0;
+    }
+    else
+    {
+        engine.getTraceRecorder().stop();
+
+        const TraceFile::Reader golden(goldenFile);
+        const TraceFile::Reader output(outputFile);
+
+        if (!golden.isValid())
+            juce::Logger::writeToLog("Trace replay: " + goldenFile.getFullPathName() + " is not a Fader Keys trace");
+        else if (compareOutput(golden, output))
+            result = 0;
+    }
+
+    juce::MessageManager::callAsync([result] {
+        if (auto *app = juce::JUCEApplicationBase::getInstance())
+            app->setApplicationReturnValue(result);
+
+        juce::JUCEApplicationBase::quit();
+    });
+}
+
+bool TraceReplay::replay()
+{
+    const TraceFile::Reader trace(traceFile);
+    if (!trace.isValid())
+        return false;
+
+    const auto ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    const auto numKeysHandledBefore = engine.getStats().getCount(EngineStats::Counter::KeyEvents);
+    int numKeyEvents = 0;
+    int numMidiIn = 0;
+
+    for (const auto &record : trace)
+    {
+        if (threadShouldExit())
+            break;
+
+        if (isRealtime)
+        {
+            const auto dueTicks = startTicks + (juce::int64)((double)record.timeMicros * 1.0e-6 * (double)ticksPerSecond);
+            const auto waitMs = juce::Time::highResolutionTicksToSeconds(dueTicks - juce::Time::getHighResolutionTicks()) * 1000.0;
+
+            if (waitMs >= 1.0)
+                wait((int)waitMs);
+        }
+
+        switch (record.type)
+        {
+        case TraceFile::RecordType::Key:
+            // Fast replays can outrun the engine, so wait for queue space rather than drop keys
+            while (!engine.postKeyEvent(record.data[0],
+                                        (record.flags & TraceFile::keyDownFlag) != 0,
+                                        record.data[1],
+                                        (record.flags & TraceFile::repeatFlag) != 0)
+                   && !threadShouldExit())
+                juce::Thread::yield();
+            ++numKeyEvents;
+            break;
+
+        case TraceFile::RecordType::MidiIn:
+            // Feedback recorded after a key went in after the engine handled it, so it does here too
+            if (!waitForEngine(numKeysHandledBefore, numKeyEvents))
+                juce::Logger::writeToLog("Trace replay: the engine thread didn't catch up before MIDI-in record "
+                                         + juce::String(numMidiIn));
+
+            engine.injectMidiInput(record.surface, record.data, record.size);
+            ++numMidiIn;
+            break;
+
+        case TraceFile::RecordType::MidiOut:
+        default:
+            break;
+        }
+    }
+
+    const auto elapsedSeconds = juce::jmax(1.0e-6, juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks));
+
+    juce::Logger::writeToLog("Replayed " + juce::String(trace.getNumRecords()) + " records ("
+                             + juce::String(numKeyEvents) + " key, " + juce::String(numMidiIn) + " MIDI in) in "
+                             + juce::String(elapsedSeconds, 3) + "s, "
+                             + juce::String((double)(numKeyEvents + numMidiIn) / elapsedSeconds, 0) + " events/s"
+                             + (isRealtime ? " (realtime)" : ""));
+
+    wait(settleMs);
+    return true;
+}
+
+bool TraceReplay::waitForEngine(juce::int64 numKeysHandledBefore, int numKeysPosted)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32)engineTimeoutMs;
+
+    while (engine.getStats().getCount(EngineStats::Counter::KeyEvents) - numKeysHandledBefore < numKeysPosted)
+    {
+        if (juce::Time::getMillisecondCounter() >= deadline || threadShouldExit())
+            return false;
+
+        juce::Thread::yield();
+    }
+
+    return true;
+}
+
+bool TraceReplay::compareOutput(const TraceFile::Reader &expected, const TraceFile::Reader &actual)
+{
+    const auto isMidiOut = [](const TraceFile::Record &record) { return record.type == TraceFile::RecordType::MidiOut; };
+
+    auto expectedIt = std::find_if(expected.begin(), expected.end(), isMidiOut);
+    auto actualIt = std::find_if(actual.begin(), actual.end(), isMidiOut);
+    int index = 0;
+
+    while (expectedIt != expected.end() && actualIt != actual.end())
+    {
+        if (!isSameMessage(*expectedIt, *actualIt))
+        {
+            juce::Logger::writeToLog("Output differs at MIDI-out message " + juce::String(index)
+                                     + ": expected " + describe(*expectedIt) + ", got " + describe(*actualIt));
+            return false;
+        }
+
+        expectedIt = std::find_if(expectedIt + 1, expected.end(), isMidiOut);
+        actualIt = std::find_if(actualIt + 1, actual.end(), isMidiOut);
+        ++index;
+    }
+
+    const auto numExpected = index + std::count_if(expectedIt, expected.end(), isMidiOut);
+    const auto numActual = index + std::count_if(actualIt, actual.end(), isMidiOut);
+
+    if (numExpected != numActual)
+    {
+        juce::Logger::writeToLog("Output has " + juce::String((int)numActual) + " MIDI-out messages, expected "
+                                 + juce::String((int)numExpected));
+        return false;
+    }
+
+    juce::Logger::writeToLog("Output matches the golden trace (" + juce::String(index) + " MIDI-out messages)");
+    return true;
+}
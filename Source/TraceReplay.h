@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "FaderEngine.h"
+#include "TraceFile.h"
+
+/**
+ * Headless replay of a recorded trace through FaderEngine, for reproducing
+ * bugs and catching regressions.
+ *
+ * Started with `--replay-trace <trace> [--realtime] [--golden <trace>] [--output <trace>]`.
+ * Key records are posted to the engine and MIDI-in records are fed to its
+ * surfaces, either as fast as the engine takes them or at their recorded
+ * times. A MIDI-in record is only fed once the engine thread has handled
+ * every key before it, so feedback never overtakes a recorded bank or
+ * fader key. The surfaces' real MIDI inputs are stopped for the replay.
+ * The engine's own output is recorded (to --output, or a temp file) and
+ * logged with the replay's throughput.
+ *
+ * With --realtime, the MIDI-out stream is compared with the golden trace,
+ * which defaults to the replayed trace itself, and the first mismatch is
+ * logged. Fast replays aren't compared: the send rate limit and held-key
+ * motion run on the engine's clock, so taps merge and holds move less than
+ * they did live.
+ */
+class TraceReplay : private juce::Thread
+{
+public:
+    TraceReplay(FaderEngine &engineToDrive, const juce::File &traceToReplay, bool shouldReplayInRealtime,
+                const juce::File &goldenTrace, const juce::File &outputTrace);
+    ~TraceReplay() override;
+
+    /** True if the command line asks for a replay instead of the normal app */
+    static bool isRequested(const juce::String &commandLine);
+
+    /** Builds a replay from the command line arguments */
+    static std::unique_ptr<TraceReplay> createFromCommandLine(FaderEngine &engine, const juce::String &commandLine);
+
+private:
+    void run() override;
+
+    /** Feeds every record to the engine. Returns false if the trace can't be read */
+    bool replay();
+
+    /** Waits until the engine thread has handled every key posted so far */
+    bool waitForEngine(juce::int64 numKeysHandledBefore, int numKeysPosted);
+
+    /** Compares MIDI-out records in order, ignoring their times. Returns true if they match */
+    static bool compareOutput(const TraceFile::Reader &expected, const TraceFile::Reader &actual);
+
+    FaderEngine &engine;
+    const juce::File traceFile;
+    const bool isRealtime;
+    const juce::File goldenFile;
+    const juce::File outputFile;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceReplay)
+};
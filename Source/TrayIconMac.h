@@ -13,6 +13,16 @@ namespace TrayIconMac
 
     void updateSensitivityMenu(FaderEngine::NudgeSensitivity sensitivity);
 
+    void updateAccelerationMenu(MotionCurve::Shape curve);
+
+    void updateHoldToTouchMenu(bool enabled);
+
+    void updateGroupMenu(bool enabled);
+
+    void updateStatsMenu(bool recording);
+
+    void updateProtocolStatus(ControlProtocol protocol, bool isMidi2 = false);
+
     void updateCapsLockState(bool capsLockOn);
 }
 
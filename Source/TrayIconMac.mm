@@ -6,7 +6,7 @@
 #include "Main.h"
 
 // A simple Objective‐C helper "handler" that can forward clicks to C++:
-@interface StatusItemHandler : NSObject
+@interface StatusItemHandler : NSObject <NSMenuDelegate>
 {
 @private
     FaderEngine* engine;
@@ -15,7 +15,14 @@
 - (void)setLowSensitivity:(id)sender;
 - (void)setMediumSensitivity:(id)sender;
 - (void)setHighSensitivity:(id)sender;
+- (void)toggleHoldToTouch:(id)sender;
+- (void)toggleGroup:(id)sender;
+- (void)toggleRecordStats:(id)sender;
+- (void)setConstantAcceleration:(id)sender;
+- (void)setLinearAcceleration:(id)sender;
+- (void)setExponentialAcceleration:(id)sender;
 - (void)quitApp:(id)sender;
+- (void)menuNeedsUpdate:(NSMenu*)menu;
 @end
 
 @implementation StatusItemHandler
@@ -55,6 +62,70 @@
     }
 }
 
+- (void)toggleHoldToTouch:(id)sender
+{
+    if (engine != nullptr)
+    {
+        const bool enabled = !engine->isHoldToTouchEnabled();
+        engine->setHoldToTouchEnabled(enabled);
+        ::TrayIconMac::updateHoldToTouchMenu(enabled);
+    }
+}
+
+- (void)toggleGroup:(id)sender
+{
+    if (engine != nullptr)
+    {
+        const bool enabled = !engine->isGroupEnabled();
+        engine->setGroupEnabled(enabled);
+        ::TrayIconMac::updateGroupMenu(enabled);
+    }
+}
+
+- (void)toggleRecordStats:(id)sender
+{
+    if (engine != nullptr)
+    {
+        const bool recording = !engine->isRecordingStats();
+        engine->setRecordingStats(recording);
+        ::TrayIconMac::updateStatsMenu(recording);
+    }
+}
+
+- (void)setConstantAcceleration:(id)sender
+{
+    if (engine != nullptr)
+    {
+        engine->setAccelerationCurve(MotionCurve::Shape::Constant);
+        ::TrayIconMac::updateAccelerationMenu(MotionCurve::Shape::Constant);
+    }
+}
+
+- (void)setLinearAcceleration:(id)sender
+{
+    if (engine != nullptr)
+    {
+        engine->setAccelerationCurve(MotionCurve::Shape::Linear);
+        ::TrayIconMac::updateAccelerationMenu(MotionCurve::Shape::Linear);
+    }
+}
+
+- (void)setExponentialAcceleration:(id)sender
+{
+    if (engine != nullptr)
+    {
+        engine->setAccelerationCurve(MotionCurve::Shape::Exponential);
+        ::TrayIconMac::updateAccelerationMenu(MotionCurve::Shape::Exponential);
+    }
+}
+
+- (void)menuNeedsUpdate:(NSMenu*)menu
+{
+    // Detection happens on the MIDI thread, so refresh the status each time the menu opens
+    if (engine != nullptr)
+        ::TrayIconMac::updateProtocolStatus(engine->getDetectedProtocol(), engine->isMidi2Active());
+}
+
 - (void)quitApp:(id)sender
 {
     // Use JUCE's quit mechanism to ensure a clean exit
@@ -71,6 +142,14 @@ namespace TrayIconMac
     static NSMenuItem* lowItem = nil;
     static NSMenuItem* mediumItem = nil;
     static NSMenuItem* highItem = nil;
+    static NSMenuItem* holdToTouchItem = nil;
+    static NSMenuItem* groupItem = nil;
+    static NSMenuItem* statsItem = nil;
+    static NSMenuItem* protocolItem = nil;
+    static NSMenuItem* constantItem = nil;
+    static NSMenuItem* linearItem = nil;
+    static NSMenuItem* exponentialItem = nil;
+    static NSMutableArray<NSMenuItem*>* trackItems = nil;
 
     // Pointers to both the normal and highlighted versions of the icon
     static NSImage* normalIcon = nil;
@@ -79,6 +158,84 @@ namespace TrayIconMac
     // Add new static property for the button
     static NSStatusBarButton* statusButton = nil;
 
+    // A compact bar for a 0-12 meter level, one cell per two steps
+    static juce::String getMeterBar(int level)
+    {
+        constexpr int numCells = (MeterLevels::maxLevel + 1) / 2;
+        const int numLit = (level + 1) / 2;
+
+        return juce::String::repeatedString(juce::CharPointer_UTF8("\xe2\x96\xae"), numLit)
+             + juce::String::repeatedString(juce::CharPointer_UTF8("\xe2\x96\xaf"), numCells - numLit);
+    }
+
+    /**
+     * Keeps the first surface's fader items up to date with their track names
+     * and meters. Names are copied only when one changed, and meters are
+     * sampled at a fixed low rate however fast the DAW sends them. Faders
+     * stay hidden until the DAW names or meters them.
+     */
+    class FaderItemTimer : public juce::Timer
+    {
+    public:
+        explicit FaderItemTimer(FaderEngine& engineToWatch) : engine(engineToWatch) { startTimer(100); }
+
+        void timerCallback() override
+        {
+            const auto& strips = engine.getScribbleStrips(0);
+            auto& meters = engine.getMeterLevels(0);
+            const auto changeCount = strips.getChangeCount();
+            const bool namesChanged = changeCount != lastChangeCount;
+            lastChangeCount = changeCount;
+
+            for (int i = 0; i < (int)[trackItems count]; ++i)
+            {
+                auto& item = items[(size_t)i];
+                bool changed = false;
+
+                if (namesChanged)
+                {
+                    auto name = strips.getName(i);
+                    changed = name != item.name;
+                    item.name = std::move(name);
+                }
+
+                // The peak since the last sample, or falling a step per sample like the hardware meters
+                const int peak = meters.takePeak(i);
+                const int level = peak >= 0 ? peak : juce::jmax(0, item.level - 1);
+                item.hasMeter = item.hasMeter || peak >= 0;
+                changed = changed || level != item.level;
+                item.level = level;
+
+                if (changed)
+                    updateItem([trackItems objectAtIndex:(NSUInteger)i], i, item);
+            }
+        }
+
+    private:
+        struct FaderItem
+        {
+            juce::String name;
+            int level = 0;
+            bool hasMeter = false;
+        };
+
+        static void updateItem(NSMenuItem* menuItem, int index, const FaderItem& item)
+        {
+            auto title = "Fader " + juce::String(index + 1) + ": " + item.name;
+            if (item.hasMeter)
+                title << "  " << getMeterBar(item.level);
+
+            [menuItem setHidden:item.name.isEmpty() && !item.hasMeter];
+            [menuItem setTitle:[NSString stringWithUTF8String:title.toRawUTF8()]];
+        }
+
+        FaderEngine& engine;
+        uint32_t lastChangeCount = 0;
+        std::array<FaderItem, ScribbleStrips::numChannels> items;
+    };
+
+    static std::unique_ptr<FaderItemTimer> faderItemTimer;
+
     // Creates the NSStatusItem, attaches a native macOS menu.
     void createStatusBarIcon(FaderEngine* engine, bool engineEnabled)
     {
@@ -148,6 +305,97 @@ namespace TrayIconMac
 
             // Separator
             [menu addItem:[NSMenuItem separatorItem]];
+
+            // Acceleration title item
+            NSMenuItem* accelerationTitleItem = [[NSMenuItem alloc] initWithTitle:@"Hold Acceleration"
+                                                                        action:nil
+                                                                 keyEquivalent:@""];
+            [accelerationTitleItem setEnabled:NO];
+            [menu addItem:accelerationTitleItem];
+
+            // Acceleration options
+            constantItem = [[NSMenuItem alloc] initWithTitle:@"None"
+                                                      action:@selector(setConstantAcceleration:)
+                                               keyEquivalent:@""];
+            linearItem = [[NSMenuItem alloc] initWithTitle:@"Linear"
+                                                    action:@selector(setLinearAcceleration:)
+                                             keyEquivalent:@""];
+            exponentialItem = [[NSMenuItem alloc] initWithTitle:@"Exponential"
+                                                         action:@selector(setExponentialAcceleration:)
+                                                  keyEquivalent:@""];
+
+            [constantItem setTarget:itemHandler];
+            [linearItem setTarget:itemHandler];
+            [exponentialItem setTarget:itemHandler];
+
+            [menu addItem:constantItem];
+            [menu addItem:linearItem];
+            [menu addItem:exponentialItem];
+
+            if (engine != nullptr)
+                updateAccelerationMenu(engine->getAccelerationCurve());
+
+            // Separator
+            [menu addItem:[NSMenuItem separatorItem]];
+
+            // Detected protocol (display only)
+            protocolItem = [[NSMenuItem alloc] initWithTitle:@""
+                                                      action:nil
+                                               keyEquivalent:@""];
+            [protocolItem setEnabled:NO];
+            [menu addItem:protocolItem];
+            updateProtocolStatus(engine != nullptr ? engine->getDetectedProtocol() : ControlProtocol::Unknown);
+
+            // Tracks the fader keys control with their meters (display only), shown once the DAW sends them
+            // Owned here (not autoreleased), the static outlives the run loop's autorelease pool
+            trackItems = [[NSMutableArray alloc] initWithCapacity:ScribbleStrips::numChannels];
+            for (int i = 0; i < ScribbleStrips::numChannels; ++i)
+            {
+                NSMenuItem* trackItem = [[NSMenuItem alloc] initWithTitle:@""
+                                                                   action:nil
+                                                            keyEquivalent:@""];
+                [trackItem setEnabled:NO];
+                [trackItem setHidden:YES];
+                [menu addItem:trackItem];
+                [trackItems addObject:trackItem];
+                [trackItem release]; // The menu and the array hold it
+            }
+
+            if (engine != nullptr)
+                faderItemTimer = std::make_unique<FaderItemTimer>(*engine);
+
+            // Touch mode
+            holdToTouchItem = [[NSMenuItem alloc] initWithTitle:@"Hold to Touch"
+                                                         action:@selector(toggleHoldToTouch:)
+                                                  keyEquivalent:@""];
+            [holdToTouchItem setTarget:itemHandler];
+            [holdToTouchItem setState:(engine != nullptr && engine->isHoldToTouchEnabled() ? NSControlStateValueOn : NSControlStateValueOff)];
+            [menu addItem:holdToTouchItem];
+
+            // Fader group, only shown once a group is set up in the settings file
+            if (engine != nullptr && engine->getFaderGroup() != 0)
+            {
+                groupItem = [[NSMenuItem alloc] initWithTitle:@"Group Faders"
+                                                       action:@selector(toggleGroup:)
+                                                keyEquivalent:@""];
+                [groupItem setTarget:itemHandler];
+                [groupItem setState:(engine->isGroupEnabled() ? NSControlStateValueOn : NSControlStateValueOff)];
+                [menu addItem:groupItem];
+            }
+
+            // Separator
+            [menu addItem:[NSMenuItem separatorItem]];
+
+            // Debug: latency and throughput stats, written next to the settings file
+            statsItem = [[NSMenuItem alloc] initWithTitle:@"Record Latency Stats"
+                                                   action:@selector(toggleRecordStats:)
+                                            keyEquivalent:@""];
+            [statsItem setTarget:itemHandler];
+            [statsItem setState:(engine != nullptr && engine->isRecordingStats() ? NSControlStateValueOn : NSControlStateValueOff)];
+            [menu addItem:statsItem];
+
+            // Separator
+            [menu addItem:[NSMenuItem separatorItem]];
         }
 
         // Quit item (always show)
@@ -158,6 +406,7 @@ namespace TrayIconMac
         [menu addItem:quitItem];
 
         // Attach menu and set highlight mode
+        [menu setDelegate:itemHandler];
         [statusItem setMenu:menu];
         [[statusItem button] cell].highlighted = (NSChangeBackgroundCellMask | NSContentsCellMask);
     }
@@ -165,6 +414,8 @@ namespace TrayIconMac
     // Destroy the status item
     void removeStatusBarIcon()
     {
+        faderItemTimer.reset();
+
         if (statusItem != nil)
         {
             [[NSStatusBar systemStatusBar] removeStatusItem:statusItem];
@@ -174,6 +425,15 @@ namespace TrayIconMac
         lowItem = nil;
         mediumItem = nil;
         highItem = nil;
+        holdToTouchItem = nil;
+        groupItem = nil;
+        statsItem = nil;
+        protocolItem = nil;
+        constantItem = nil;
+        linearItem = nil;
+        exponentialItem = nil;
+        [trackItems release];
+        trackItems = nil;
         normalIcon = nil;
         highlightedIcon = nil;
     }
@@ -197,6 +457,54 @@ namespace TrayIconMac
         }
     }
 
+    void updateAccelerationMenu(MotionCurve::Shape curve)
+    {
+        if (constantItem && linearItem && exponentialItem)
+        {
+            [constantItem setState:(curve == MotionCurve::Shape::Constant ? NSControlStateValueOn : NSControlStateValueOff)];
+            [linearItem setState:(curve == MotionCurve::Shape::Linear ? NSControlStateValueOn : NSControlStateValueOff)];
+            [exponentialItem setState:(curve == MotionCurve::Shape::Exponential ? NSControlStateValueOn : NSControlStateValueOff)];
+        }
+    }
+
+    void updateProtocolStatus(ControlProtocol protocol, bool isMidi2)
+    {
+        if (protocolItem == nil)
+            return;
+
+        switch (protocol)
+        {
+        case ControlProtocol::Hui:
+            [protocolItem setTitle:@"Protocol: HUI"];
+            break;
+        case ControlProtocol::Mcu:
+            [protocolItem setTitle:(isMidi2 ? @"Protocol: MCU (MIDI 2.0)" : @"Protocol: MCU")];
+            break;
+        case ControlProtocol::Unknown:
+        default:
+            [protocolItem setTitle:@"Protocol: Detecting (HUI + MCU)"];
+            break;
+        }
+    }
+
+    void updateHoldToTouchMenu(bool enabled)
+    {
+        if (holdToTouchItem)
+            [holdToTouchItem setState:(enabled ? NSControlStateValueOn : NSControlStateValueOff)];
+    }
+
+    void updateGroupMenu(bool enabled)
+    {
+        if (groupItem)
+            [groupItem setState:(enabled ? NSControlStateValueOn : NSControlStateValueOff)];
+    }
+
+    void updateStatsMenu(bool recording)
+    {
+        if (statsItem)
+            [statsItem setState:(recording ? NSControlStateValueOn : NSControlStateValueOff)];
+    }
+
     void updateCapsLockState(bool capsLockOn)
     {
         if (statusItem == nil || statusButton == nil)
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "MidiEncoding.h"
+
+/**
+ * Fixed-size MIDI 2.0 Universal MIDI Packet encoders for the MCU messages
+ * FaderEngine sends when the DAW talks MIDI 2.0. Like MidiEncoding, every
+ * burst is a std::array of complete packets, so nothing touches the heap.
+ *
+ * Fader positions go out as 64-bit MIDI 2.0 pitch bend with a 32-bit value,
+ * one packet per fader update. Everything else keeps its MCU meaning.
+ */
+namespace UmpEncoding
+{
+    template <size_t NumWords>
+    using Words = std::array<uint32_t, NumWords>;
+
+    // Message types (top nibble of the first word)
+    constexpr uint8_t midi1ChannelVoiceType = 0x2;
+    constexpr uint8_t sysex7Type = 0x3;
+    constexpr uint8_t midi2ChannelVoiceType = 0x4;
+
+    // Sysex7 packet status, in the nibble after the group
+    constexpr uint8_t sysex7Complete = 0x0;
+    constexpr uint8_t sysex7Start = 0x1;
+    constexpr uint8_t sysex7Continue = 0x2;
+    constexpr uint8_t sysex7End = 0x3;
+    constexpr size_t sysex7BytesPerPacket = 6;
+
+    // Everything goes out on group 1
+    constexpr uint8_t group = 0;
+
+    /** Size of a packet from its first word, by message type */
+    constexpr int getNumWords(uint32_t firstWord)
+    {
+        constexpr std::array<uint8_t, 16> wordsForType{{1, 1, 1, 2, 2, 4, 1, 1, 2, 2, 2, 3, 3, 4, 4, 4}};
+        return wordsForType[firstWord >> 28];
+    }
+
+    constexpr uint8_t getType(uint32_t firstWord) { return static_cast<uint8_t>(firstWord >> 28); }
+    constexpr uint8_t getStatus(uint32_t firstWord) { return static_cast<uint8_t>((firstWord >> 16) & 0xF0); }
+    constexpr uint8_t getChannel(uint32_t firstWord) { return static_cast<uint8_t>((firstWord >> 16) & 0x0F); }
+
+    //==============================================================================
+    /** 14-bit to 32-bit with the MIDI 2.0 min-centre-max upscaling, so 0, centre and full scale map exactly */
+    constexpr uint32_t scale14To32(int value)
+    {
+        const auto source = static_cast<uint32_t>(value) & 0x3FFF;
+        auto scaled = source << 18;
+
+        if (source <= 0x2000)
+            return scaled;
+
+        // Repeat the bits below the top one down through the new low bits
+        auto repeat = (source & 0x1FFF) << 5;
+        while (repeat != 0)
+        {
+            scaled |= repeat;
+            repeat >>= 13;
+        }
+
+        return scaled;
+    }
+
+    constexpr int scale32To14(uint32_t value) { return static_cast<int>(value >> 18); }
+
+    static_assert(scale14To32(0) == 0 && scale14To32(0x2000) == 0x80000000u && scale14To32(0x3FFF) == 0xFFFFFFFFu,
+                  "Upscaling must keep min, centre and max");
+
+    //==============================================================================
+    /** MCU/Logic fader position as a 32-bit MIDI 2.0 pitch bend, faders 1-8 on channels 1-8 */
+    constexpr Words<2> pitchBend(int faderIndex, int value)
+    {
+        const auto status = static_cast<uint32_t>(MidiEncoding::pitchWheelStatus | (faderIndex & 0x0F));
+        return {{(uint32_t)midi2ChannelVoiceType << 28 | (uint32_t)group << 24 | status << 16, scale14To32(value)}};
+    }
+
+    /** MCU fader touch as a MIDI 2.0 note on at full 16-bit velocity */
+    constexpr Words<2> mcuTouch(int faderIndex)
+    {
+        const auto note = static_cast<uint32_t>(MidiEncoding::mcuFaderTouchNote + (faderIndex & 0x07));
+        return {{(uint32_t)midi2ChannelVoiceType << 28 | (uint32_t)group << 24 | (uint32_t)MidiEncoding::noteOnStatus << 16 | note << 8,
+                 0xFFFFu << 16}};
+    }
+
+    /** MCU fader release. MIDI 2.0 has no velocity-0 note off, so this is a real note off */
+    constexpr Words<2> mcuRelease(int faderIndex)
+    {
+        const auto note = static_cast<uint32_t>(MidiEncoding::mcuFaderTouchNote + (faderIndex & 0x07));
+        return {{(uint32_t)midi2ChannelVoiceType << 28 | (uint32_t)group << 24 | (uint32_t)MidiEncoding::noteOffStatus << 16 | note << 8,
+                 0}};
+    }
+
+    /** Wraps a MIDI 1.0 burst into MIDI 1.0 channel voice packets, for messages with no 2.0 counterpart */
+    template <size_t Size>
+    constexpr Words<Size / MidiEncoding::messageSize> fromMidi1(const std::array<uint8_t, Size> &burst)
+    {
+        Words<Size / MidiEncoding::messageSize> words{};
+        for (size_t i = 0; i < words.size(); ++i)
+        {
+            const auto *message = burst.data() + i * MidiEncoding::messageSize;
+            words[i] = (uint32_t)midi1ChannelVoiceType << 28 | (uint32_t)group << 24
+                       | (uint32_t)message[0] << 16 | (uint32_t)message[1] << 8 | message[2];
+        }
+        return words;
+    }
+
+    //==============================================================================
+    /** Splits a sysex body (no F0/F7) into sysex7 packets and calls packetCallback(const uint32_t*, int) for each */
+    template <typename Callback>
+    void forEachSysex7Packet(const uint8_t *data, size_t size, Callback &&packetCallback)
+    {
+        size_t offset = 0;
+        do
+        {
+            const size_t numBytes = size - offset < sysex7BytesPerPacket ? size - offset : sysex7BytesPerPacket;
+            const bool isFirst = offset == 0;
+            const bool isLast = offset + numBytes == size;
+            const uint8_t status = isFirst ? (isLast ? sysex7Complete : sysex7Start)
+                                           : (isLast ? sysex7End : sysex7Continue);
+
+            std::array<uint8_t, sysex7BytesPerPacket> bytes{};
+            for (size_t i = 0; i < numBytes; ++i)
+                bytes[i] = data[offset + i] & 0x7F;
+
+            const Words<2> packet{{(uint32_t)sysex7Type << 28 | (uint32_t)group << 24 | (uint32_t)status << 20
+                                       | (uint32_t)numBytes << 16 | (uint32_t)bytes[0] << 8 | bytes[1],
+                                   (uint32_t)bytes[2] << 24 | (uint32_t)bytes[3] << 16 | (uint32_t)bytes[4] << 8 | bytes[5]}};
+            packetCallback(packet.data(), (int)packet.size());
+
+            offset += numBytes;
+        } while (offset < size);
+    }
+}
@@ -0,0 +1,11 @@
+#include "UmpPort.h"
+
+#if !JUCE_MAC
+
+// No MIDI 2.0 virtual ports outside macOS yet, surfaces fall back to MIDI 1.0
+std::unique_ptr<UmpPort> UmpPort::create(const juce::String &, const juce::String &, Callback &)
+{
+    return nullptr;
+}
+
+#endif
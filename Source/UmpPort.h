@@ -0,0 +1,34 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+
+/**
+ * A virtual MIDI 2.0 port pair that carries Universal MIDI Packets as-is,
+ * next to a surface's MIDI 1.0 ports. JUCE's MidiInput/MidiOutput only speak
+ * the MIDI 1.0 byte stream, so each platform provides its own: CoreMIDI
+ * protocol 2.0 endpoints on macOS 11+ (UmpPortMac.mm). Elsewhere create()
+ * returns nullptr and the surface stays on MIDI 1.0.
+ */
+class UmpPort
+{
+public:
+    /** Receives incoming packets on the platform's MIDI input thread */
+    class Callback
+    {
+    public:
+        virtual ~Callback() = default;
+
+        /** One or more whole packets, back to back */
+        virtual void handleIncomingUmp(const uint32_t *words, int numWords) = 0;
+    };
+
+    virtual ~UmpPort() = default;
+
+    /** Sends whole packets in a single call. Safe to call from any thread */
+    virtual void send(const uint32_t *words, int numWords) = 0;
+
+    /** Creates the port pair, or returns nullptr if the platform has no MIDI 2.0 virtual ports */
+    static std::unique_ptr<UmpPort> create(const juce::String &outputName, const juce::String &inputName,
+                                           Callback &callback);
+};
@@ -0,0 +1,95 @@
+#if JUCE_MAC
+
+#include "UmpPort.h"
+
+#import <CoreMIDI/CoreMIDI.h>
+#include <array>
+
+namespace
+{
+    // Room for the largest send (a full MIDI-CI message as sysex7 packets), kept on the stack
+    constexpr size_t eventListBytes = 2048;
+
+    class API_AVAILABLE(macos(11.0)) UmpPortMac : public UmpPort
+    {
+    public:
+        explicit UmpPortMac(Callback &callbackToUse) : callback(callbackToUse) {}
+
+        ~UmpPortMac() override
+        {
+            if (destination != 0)
+                MIDIEndpointDispose(destination);
+            if (source != 0)
+                MIDIEndpointDispose(source);
+            if (client != 0)
+                MIDIClientDispose(client);
+        }
+
+        bool open(const juce::String &outputName, const juce::String &inputName)
+        {
+            if (MIDIClientCreateWithBlock(CFSTR("Fader Keys MIDI 2.0"), &client, nil) != noErr)
+                return false;
+
+            const auto outputCFName = outputName.toCFString();
+            const auto inputCFName = inputName.toCFString();
+
+            auto status = MIDISourceCreateWithProtocol(client, outputCFName, kMIDIProtocol_2_0, &source);
+
+            if (status == noErr)
+            {
+                auto *callbackToCall = &callback;
+                status = MIDIDestinationCreateWithProtocol(client, inputCFName, kMIDIProtocol_2_0, &destination,
+                                                           ^(const MIDIEventList *eventList, void *) {
+                                                               const auto *packet = &eventList->packet[0];
+                                                               for (UInt32 i = 0; i < eventList->numPackets; ++i)
+                                                               {
+                                                                   callbackToCall->handleIncomingUmp(packet->words, (int)packet->wordCount);
+                                                                   packet = MIDIEventPacketNext(packet);
+                                                               }
+                                                           });
+            }
+
+            CFRelease(outputCFName);
+            CFRelease(inputCFName);
+            return status == noErr;
+        }
+
+        void send(const uint32_t *words, int numWords) override
+        {
+            // Every packet in a send shares one timestamp, so CoreMIDI keeps them in one event packet
+            alignas(MIDIEventList) std::array<Byte, eventListBytes> storage;
+            auto *eventList = reinterpret_cast<MIDIEventList *>(storage.data());
+            auto *packet = MIDIEventListInit(eventList, kMIDIProtocol_2_0);
+
+            packet = MIDIEventListAdd(eventList, storage.size(), packet, 0, (ByteCount)numWords, words);
+            jassert(packet != nullptr);
+
+            if (packet != nullptr)
+                MIDIReceivedEventList(source, eventList);
+        }
+
+    private:
+        Callback &callback;
+
+        MIDIClientRef client = 0;
+        MIDIEndpointRef source = 0;
+        MIDIEndpointRef destination = 0;
+    };
+}
+
+std::unique_ptr<UmpPort> UmpPort::create(const juce::String &outputName, const juce::String &inputName,
+                                         Callback &callback)
+{
+    if (@available(macOS 11.0, *))
+    {
+        auto port = std::make_unique<UmpPortMac>(callback);
+        if (port->open(outputName, inputName))
+            return port;
+
+        DBG("Failed to create MIDI 2.0 ports " << outputName);
+    }
+
+    return nullptr;
+}
+
+#endif